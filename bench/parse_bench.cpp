@@ -0,0 +1,88 @@
+// Request parser microbenchmark, comparing the scalar, SSE4.2 and AVX2
+// delimiter scanners on a typical request and on one with a large cookie.
+//
+//   clang++ -std=c++2c -O3 ./bench/parse_bench.cpp -o ./build/parse_bench
+
+#include <chrono>
+#include <cstdint>
+#include <span>
+#include <string>
+#include "../src/request_parser.cpp"
+
+namespace {
+
+constexpr size_t ITERATIONS = 200'000;
+
+std::string make_request(size_t cookie_size) {
+    std::string request =
+        "GET /api/v1/users/12345/profile?fields=name,email HTTP/1.1\r\n"
+        "Host: example.com\r\n"
+        "User-Agent: Mozilla/5.0 (X11; Linux x86_64) AppleWebKit/537.36 "
+        "(KHTML, like Gecko) Chrome/124.0.0.0 Safari/537.36\r\n"
+        "Accept: text/html,application/xhtml+xml,application/xml;q=0.9,"
+        "*/*;q=0.8\r\n"
+        "Accept-Language: en-US,en;q=0.9\r\n"
+        "Accept-Encoding: gzip, deflate, br\r\n"
+        "Connection: keep-alive\r\n"
+        "Referer: https://example.com/dashboard/settings/profile\r\n";
+
+    if (cookie_size > 0) {
+        request += "Cookie: session=";
+        for (size_t i = 0; i < cookie_size; ++i) {
+            request += static_cast<char>('a' + i % 26);
+        }
+        request += "\r\n";
+    }
+
+    request += "\r\n";
+    return request;
+}
+
+// 요청 하나를 파싱하는 평균 시간 (ns)
+double parse_time(std::string& raw) {
+    http::RequestParser parser;
+    http::Request request{};
+    uint64_t consumed = 0;
+
+    auto start = std::chrono::steady_clock::now();
+    for (size_t i = 0; i < ITERATIONS; ++i) {
+        consumed += parser.parse(std::span<char>(raw), request).consumed;
+    }
+    auto end = std::chrono::steady_clock::now();
+
+    if (consumed != raw.size() * ITERATIONS) {
+        std::println("parse failed");
+    }
+
+    return std::chrono::duration<double, std::nano>(end - start).count() /
+           ITERATIONS;
+}
+
+}  // namespace
+
+int main() {
+    std::string small = make_request(0);
+    std::string large = make_request(8 * 1024);
+
+    std::println("cpu supports: {}",
+        http::scan_level_to_string(http::detail::detect_scan_level()));
+    std::println("{:<8} {:>14} {:>14} {:>12}", "level", "small (ns)",
+        "8K cookie (ns)", "GB/s");
+
+    for (http::ScanLevel level : {http::ScanLevel::Scalar,
+             http::ScanLevel::Sse42, http::ScanLevel::Avx2}) {
+        http::set_scan_level(level);
+        if (http::scan_level() != level) {
+            continue;
+        }
+
+        double small_time = parse_time(small);
+        double large_time = parse_time(large);
+
+        std::println("{:<8} {:>14.1f} {:>14.1f} {:>12.2f}",
+            http::scan_level_to_string(level), small_time, large_time,
+            static_cast<double>(large.size()) / large_time);
+    }
+
+    return 0;
+}
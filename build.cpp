@@ -5,7 +5,13 @@ int main() {
         .set_project_name("http.cpp2")
         .set_compiler(nobpp::Compiler::clang)
         .set_language(nobpp::Language::cpp)
+#ifdef _WIN32
         .set_target_os(nobpp::TargetOS::windows)
+#else
+        .set_target_os(nobpp::TargetOS::linux)
+        .add_option("-pthread")
+#endif
+        .add_option("-lz")
         .add_option("-DLOG_LEVEL_INFO")
         .add_file("./src/main.cpp")
         .add_option("-std=c++2c")
@@ -0,0 +1,169 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <memory_resource>
+#include "buffer_pool.hpp"
+#include "log.hpp"
+
+namespace http {
+
+/**
+ * Per-connection monotonic allocator for everything built while answering
+ * its requests: request header overflow, response header fields and handler
+ * scratch. Memory comes in `POOL_BUFFER_SIZE` blocks from the thread's
+ * `BufferPool`, larger requests get a block of their own, and nothing is
+ * freed until `reset()`, which keeps the first block for the next request.
+ *
+ * The socket makes a connection's arena current, see `Arena::current()`,
+ * while it parses and answers that connection's requests, and resets it once
+ * every response queued on the connection has been sent, since bodies may
+ * point into it until then.
+ */
+class Arena : public std::pmr::memory_resource {
+public:
+    /**
+     * Makes `arena` the current arena of this thread until the scope ends.
+     */
+    class Scope {
+    public:
+        explicit Scope(Arena& arena) noexcept : previous(Arena::active()) {
+            Arena::active() = &arena;
+        }
+
+        Scope(Scope&) = delete;
+        Scope& operator=(Scope&) = delete;
+
+        ~Scope() {
+            Arena::active() = self.previous;
+        }
+
+    private:
+        Scope& self = *this;
+
+        Arena* previous;
+    };
+
+public:
+    Arena() = default;
+    Arena(Arena&) = delete;
+    Arena& operator=(Arena&) = delete;
+
+    ~Arena() override {
+        self.release(nullptr);
+        self.release_large();
+    }
+
+    /**
+     * Frees everything allocated so far at once, keeping the first block.
+     */
+    void reset() noexcept {
+        self.release_large();
+        if (self.first == nullptr) {
+            return;
+        }
+
+        self.release(self.first);
+        self.blocks = self.first;
+        self.cursor = Arena::data(self.first);
+        self.limit = reinterpret_cast<char*>(self.first) + POOL_BUFFER_SIZE;
+    }
+
+    /**
+     * The arena of the request being answered on this thread, or the global
+     * allocator outside of one.
+     */
+    static std::pmr::memory_resource* current() noexcept {
+        Arena* arena = Arena::active();
+        if (arena == nullptr) {
+            return std::pmr::new_delete_resource();
+        }
+        return arena;
+    }
+
+protected:
+    void* do_allocate(size_t bytes, size_t alignment) override {
+        char* data = Arena::align(self.cursor, alignment);
+        if (self.cursor != nullptr && data + bytes <= self.limit) {
+            self.cursor = data + bytes;
+            return data;
+        }
+
+        // 풀 버퍼에 들어가지 않으면 따로 할당해 reset 때 돌려준다
+        if (sizeof(Block) + bytes + alignment > POOL_BUFFER_SIZE) {
+            size_t capacity = sizeof(Block) + bytes + alignment;
+            Block* block =
+                new (new char[capacity]) Block{self.large, capacity};
+            self.large = block;
+            return Arena::align(Arena::data(block), alignment);
+        }
+
+        Block* block = new (BufferPool::local().acquire())
+            Block{self.blocks, POOL_BUFFER_SIZE};
+        if (self.first == nullptr) {
+            self.first = block;
+        }
+        self.blocks = block;
+        data = Arena::align(Arena::data(block), alignment);
+        self.cursor = data + bytes;
+        self.limit = reinterpret_cast<char*>(block) + POOL_BUFFER_SIZE;
+        return data;
+    }
+
+    // 하나씩 돌려주지 않고 reset 에서 한꺼번에 돌려준다
+    void do_deallocate(void*, size_t, size_t) noexcept override {}
+
+    bool do_is_equal(
+        const std::pmr::memory_resource& other) const noexcept override {
+        return this == &other;
+    }
+
+private:
+    // 블록 맨 앞에 놓이는 머리, 최근 블록부터 이어진다
+    struct Block {
+        Block* next;
+        size_t capacity;
+    };
+
+    static Arena*& active() noexcept {
+        thread_local Arena* arena = nullptr;
+        return arena;
+    }
+
+    static char* data(Block* block) noexcept {
+        return reinterpret_cast<char*>(block) + sizeof(Block);
+    }
+
+    static char* align(char* pointer, size_t alignment) noexcept {
+        uintptr_t address = reinterpret_cast<uintptr_t>(pointer);
+        return pointer + ((alignment - address % alignment) % alignment);
+    }
+
+    // keep 앞까지의 블록을 풀에 돌려준다
+    void release(Block* keep) noexcept {
+        while (self.blocks != nullptr && self.blocks != keep) {
+            Block* next = self.blocks->next;
+            BufferPool::local().release(reinterpret_cast<char*>(self.blocks));
+            self.blocks = next;
+        }
+    }
+
+    void release_large() noexcept {
+        while (self.large != nullptr) {
+            Block* next = self.large->next;
+            delete[] reinterpret_cast<char*>(self.large);
+            self.large = next;
+        }
+    }
+
+private:
+    Arena& self = *this;
+
+    Block* blocks = nullptr;  // 풀 버퍼 블록, 가장 최근 것부터
+    Block* first = nullptr;   // reset 해도 남겨 두는 첫 블록
+    Block* large = nullptr;   // 풀 버퍼보다 큰 블록
+    char* cursor = nullptr;   // 현재 블록의 빈 곳
+    char* limit = nullptr;
+};
+
+}  // namespace http
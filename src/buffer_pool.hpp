@@ -0,0 +1,71 @@
+#pragma once
+
+#include <cstddef>
+#include <new>
+#include "log.hpp"
+
+namespace http {
+
+static constexpr size_t POOL_BUFFER_SIZE = 16 * 1024;
+static constexpr size_t POOL_MAX_FREE_BUFFERS = 256;  // 스레드당 최대 4 MiB
+
+/**
+ * Per-thread freelist of fixed-size send buffers, so sending a response does
+ * not go through the global allocator. A buffer released on another thread
+ * than the one that acquired it joins that thread's list; lists are capped and
+ * anything beyond the cap goes back to the allocator.
+ */
+class BufferPool {
+public:
+    BufferPool() = default;
+    BufferPool(BufferPool&) = delete;
+    BufferPool& operator=(BufferPool&) = delete;
+
+    ~BufferPool() {
+        while (self.free_list != nullptr) {
+            FreeBuffer* next = self.free_list->next;
+            delete[] reinterpret_cast<char*>(self.free_list);
+            self.free_list = next;
+        }
+    }
+
+    static BufferPool& local() noexcept {
+        thread_local BufferPool pool;
+        return pool;
+    }
+
+    char* acquire() {
+        if (self.free_list == nullptr) {
+            return new char[POOL_BUFFER_SIZE];
+        }
+
+        FreeBuffer* buffer = self.free_list;
+        self.free_list = buffer->next;
+        --self.free_count;
+        return reinterpret_cast<char*>(buffer);
+    }
+
+    void release(char* buffer) noexcept {
+        if (self.free_count == POOL_MAX_FREE_BUFFERS) {
+            delete[] buffer;
+            return;
+        }
+
+        // 빈 버퍼의 앞부분을 다음 버퍼 포인터로 쓴다
+        self.free_list = new (buffer) FreeBuffer{self.free_list};
+        ++self.free_count;
+    }
+
+private:
+    struct FreeBuffer {
+        FreeBuffer* next;
+    };
+
+private:
+    BufferPool& self = *this;
+
+    FreeBuffer* free_list = nullptr;
+    size_t free_count = 0;
+};
+
+}  // namespace http
@@ -0,0 +1,198 @@
+#include "byte_range.hpp"
+#include <algorithm>
+#include <format>
+#include <iterator>
+#include <limits>
+#include <random>
+#include <string>
+#include "log.hpp"
+#include "string_utils.hpp"
+
+namespace http {
+
+namespace {
+
+std::optional<uint64_t> parse_number(std::string_view digits) noexcept {
+    if (digits.empty()) {
+        return std::nullopt;
+    }
+
+    uint64_t value = 0;
+    for (char c : digits) {
+        if (c < '0' || c > '9') {
+            return std::nullopt;
+        }
+        uint64_t digit = static_cast<uint64_t>(c - '0');
+        if (value > (std::numeric_limits<uint64_t>::max() - digit) / 10) {
+            return std::nullopt;
+        }
+        value = value * 10 + digit;
+    }
+    return value;
+}
+
+// If-Range 는 강한 ETag 나 Last-Modified 와 정확히 같을 때만 맞는다
+bool matches_validator(const Response& response, std::string_view validator) {
+    const auto& fields = response.fields;
+    if (validator.starts_with('"')) {
+        auto etag = fields.find("ETag");
+        return etag != fields.end() && etag->second == validator;
+    }
+
+    auto last_modified = fields.find("Last-Modified");
+    return last_modified != fields.end() && last_modified->second == validator;
+}
+
+std::string make_boundary() {
+    thread_local std::mt19937_64 random(std::random_device{}());
+    return std::format("{:016x}{:016x}", random(), random());
+}
+
+}  // namespace
+
+std::optional<std::pmr::vector<ByteRange>> parse_byte_ranges(
+    std::string_view value, uint64_t size) {
+    LOG_TRACE("http::parse_byte_ranges()");
+
+    value = trim(value);
+    if (value.size() < 6 || !iequals(value.substr(0, 6), "bytes=")) {
+        return std::nullopt;
+    }
+
+    std::pmr::vector<ByteRange> ranges{Arena::current()};
+    size_t count = 0;
+    for (std::string_view spec : split(value.substr(6), ',')) {
+        spec = trim(spec);
+        if (spec.empty()) {
+            continue;
+        }
+        if (++count > MAX_BYTE_RANGES) {
+            return std::nullopt;
+        }
+
+        size_t dash = spec.find('-');
+        if (dash == std::string_view::npos) {
+            return std::nullopt;
+        }
+
+        // "-n" 은 마지막 n 바이트다
+        if (dash == 0) {
+            std::optional<uint64_t> suffix = parse_number(spec.substr(1));
+            if (!suffix.has_value()) {
+                return std::nullopt;
+            }
+            if (suffix.value() > 0 && size > 0) {
+                ranges.push_back(ByteRange{
+                    size - std::min(suffix.value(), size), size - 1});
+            }
+            continue;
+        }
+
+        std::optional<uint64_t> first = parse_number(spec.substr(0, dash));
+        std::string_view last_digits = spec.substr(dash + 1);
+        std::optional<uint64_t> last =
+            last_digits.empty()
+                ? std::optional(std::numeric_limits<uint64_t>::max())
+                : parse_number(last_digits);
+        if (!first.has_value() || !last.has_value() ||
+            last.value() < first.value()) {
+            return std::nullopt;
+        }
+
+        // 끝을 넘는 시작은 만족할 수 없고, 넘는 끝은 잘라낸다
+        if (first.value() < size) {
+            ranges.push_back(
+                ByteRange{first.value(), std::min(last.value(), size - 1)});
+        }
+    }
+
+    if (count == 0) {
+        return std::nullopt;
+    }
+    return std::optional(std::move(ranges));
+}
+
+void apply_byte_ranges(Response& response, std::string_view range,
+    std::optional<std::string_view> if_range) {
+    LOG_TRACE("http::apply_byte_ranges()");
+
+    // 스트림은 되돌아갈 수 없으니 전체를 보낸다
+    if (response.http_code != HttpCode::Ok || !response.parts.empty() ||
+        response.stream.has_value()) {
+        return;
+    }
+    if (if_range.has_value() &&
+        !matches_validator(response, trim(if_range.value()))) {
+        return;
+    }
+
+    uint64_t size = Response::body_size(response);
+    std::optional<std::pmr::vector<ByteRange>> ranges =
+        parse_byte_ranges(range, size);
+    if (!ranges.has_value()) {
+        return;
+    }
+
+    if (ranges->empty()) {
+        // 416 에는 본문이 없으므로 어떤 본문도 남기지 않는다
+        response.http_code = HttpCode::RangeNotSatisfiable;
+        response.body = {};
+        response.body_owner.reset();
+        response.file.reset();
+        response.parts.clear();
+        response.stream.reset();
+        std::pmr::string& content_range = response.fields["Content-Range"];
+        content_range.clear();
+        std::format_to(std::back_inserter(content_range), "bytes */{}", size);
+        response.fields["Content-Length"] = "0";
+        return;
+    }
+
+    response.http_code = HttpCode::PartialContent;
+    response.fields["Accept-Ranges"] = "bytes";
+
+    if (ranges->size() == 1) {
+        const ByteRange& only = ranges->front();
+        uint64_t length = only.last - only.first + 1;
+        if (response.file.has_value()) {
+            response.file->offset += only.first;
+            response.file->length = length;
+        } else {
+            response.body = response.body.substr(
+                static_cast<size_t>(only.first), static_cast<size_t>(length));
+        }
+
+        // 아레나에 있는 필드 값에 바로 쓴다
+        std::pmr::string& content_range = response.fields["Content-Range"];
+        content_range.clear();
+        std::format_to(std::back_inserter(content_range), "bytes {}-{}/{}",
+            only.first, only.last, size);
+        response.fields["Content-Length"] = LengthText{}.format(length);
+        return;
+    }
+
+    // 각 부분의 헤더만 만들고 본문은 원래 본문이나 파일의 구간을 가리킨다
+    std::string part_type;
+    if (auto content_type = response.fields.find("Content-Type");
+        content_type != response.fields.end()) {
+        part_type = std::format("Content-Type: {}\r\n", content_type->second);
+    }
+
+    std::string boundary = make_boundary();
+    response.parts.reserve(ranges->size() + 1);
+    for (const ByteRange& part : ranges.value()) {
+        response.parts.push_back(BodyPart{
+            std::format("\r\n--{}\r\n{}Content-Range: bytes {}-{}/{}\r\n\r\n",
+                boundary, part_type, part.first, part.last, size),
+            part.first, part.last - part.first + 1});
+    }
+    response.parts.push_back(
+        BodyPart{std::format("\r\n--{}--\r\n", boundary), 0, 0});
+
+    response.fields["Content-Type"] =
+        std::format("multipart/byteranges; boundary={}", boundary);
+    response.fields["Content-Length"] =
+        LengthText{}.format(Response::body_size(response));
+}
+
+}  // namespace http
@@ -0,0 +1,42 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <memory_resource>
+#include <optional>
+#include <string_view>
+#include <vector>
+#include "arena.hpp"
+#include "response.hpp"
+
+namespace http {
+
+// 한 요청에서 받아들이는 최대 구간 수, 넘으면 Range 를 무시한다
+static constexpr size_t MAX_BYTE_RANGES = 16;
+
+// 양 끝을 포함하는 바이트 구간
+struct ByteRange {
+    uint64_t first;
+    uint64_t last;
+};
+
+/**
+ * Parses a `Range` field value against a representation of `size` bytes.
+ * Returns nullopt when the field must be ignored (bad syntax, another unit or
+ * too many ranges) and an empty list when no range is satisfiable. The list
+ * is allocated from the current request's arena.
+ */
+std::optional<std::pmr::vector<ByteRange>> parse_byte_ranges(
+    std::string_view value, uint64_t size);
+
+/**
+ * Turns a 200 response into a 206 carrying only the ranges asked for in
+ * `range`, or a 416 when none of them can be served. A single range narrows
+ * the body or file in place; several become `multipart/byteranges` parts that
+ * still point into the original body or file, so nothing is copied. Anything
+ * else, or an `If-Range` that does not match the response's `ETag` or
+ * `Last-Modified`, leaves the full response untouched.
+ */
+void apply_byte_ranges(Response& response, std::string_view range,
+    std::optional<std::string_view> if_range);
+
+}  // namespace http
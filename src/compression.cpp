@@ -0,0 +1,316 @@
+#include "compression.hpp"
+#include <array>
+#include <format>
+#include <zlib.h>
+#include "log.hpp"
+#include "string_utils.hpp"
+
+namespace http {
+
+namespace {
+
+// 천분율 q 값, 목록에 없으면 -1
+struct EncodingWeights {
+    int32_t gzip = -1;
+    int32_t deflate = -1;
+};
+
+int32_t parse_qvalue(std::string_view parameters) noexcept {
+    for (std::string_view parameter : split(parameters, ';')) {
+        parameter = trim(parameter);
+        if (parameter.size() < 2 || ascii_lowercase(parameter[0]) != 'q' ||
+            parameter[1] != '=') {
+            continue;
+        }
+
+        // "0", "0.5", "1.000" 같은 형식만 있다
+        std::string_view value = parameter.substr(2);
+        if (value.empty() || (value[0] != '0' && value[0] != '1')) {
+            return 0;
+        }
+        int32_t weight = (value[0] - '0') * 1000;
+        int32_t scale = 100;
+        for (char c : value.substr(std::min<size_t>(2, value.size()))) {
+            if (c < '0' || c > '9' || scale == 0) {
+                break;
+            }
+            weight += (c - '0') * scale;
+            scale /= 10;
+        }
+        return std::min(weight, 1000);
+    }
+    return 1000;
+}
+
+EncodingWeights parse_accept_encoding(
+    std::string_view accept_encoding) noexcept {
+    EncodingWeights weights{};
+    int32_t any = -1;
+
+    for (std::string_view item : split(accept_encoding, ',')) {
+        size_t semicolon = item.find(';');
+        std::string_view name = trim(item.substr(0, semicolon));
+        int32_t weight = semicolon == std::string_view::npos
+                             ? 1000
+                             : parse_qvalue(item.substr(semicolon + 1));
+
+        if (iequals(name, "gzip") || iequals(name, "x-gzip")) {
+            weights.gzip = weight;
+        } else if (iequals(name, "deflate")) {
+            weights.deflate = weight;
+        } else if (name == "*") {
+            any = weight;
+        }
+    }
+
+    // 이름이 없는 압축은 "*" 의 q 값을 따른다
+    if (weights.gzip < 0) {
+        weights.gzip = any;
+    }
+    if (weights.deflate < 0) {
+        weights.deflate = any;
+    }
+    return weights;
+}
+
+/**
+ * One zlib deflater per coding, set up on first use and reset between
+ * bodies, so a thread pays for `deflateInit2` once.
+ */
+class Deflaters {
+public:
+    Deflaters() = default;
+    Deflaters(Deflaters&) = delete;
+    Deflaters& operator=(Deflaters&) = delete;
+
+    ~Deflaters() {
+        for (size_t i = 0; i < self.streams.size(); ++i) {
+            if (self.ready[i]) {
+                deflateEnd(&self.streams[i]);
+            }
+        }
+    }
+
+    static Deflaters& local() noexcept {
+        thread_local Deflaters deflaters;
+        return deflaters;
+    }
+
+    z_stream* get(ContentEncoding encoding, int32_t level) noexcept {
+        size_t index = encoding == ContentEncoding::Gzip ? 0 : 1;
+        z_stream& stream = self.streams[index];
+
+        if (self.ready[index] && self.levels[index] != level) {
+            deflateEnd(&stream);
+            self.ready[index] = false;
+        }
+
+        if (self.ready[index]) {
+            deflateReset(&stream);
+            return &stream;
+        }
+
+        // windowBits 에 16 을 더하면 gzip, 그대로면 zlib 형식이다
+        stream = z_stream{};
+        int32_t window_bits = encoding == ContentEncoding::Gzip ? 15 + 16 : 15;
+        if (deflateInit2(&stream, level, Z_DEFLATED, window_bits, 8,
+                Z_DEFAULT_STRATEGY) != Z_OK) {
+            return nullptr;
+        }
+        self.ready[index] = true;
+        self.levels[index] = level;
+        return &stream;
+    }
+
+private:
+    Deflaters& self = *this;
+
+    std::array<z_stream, 2> streams{};
+    std::array<bool, 2> ready{};
+    std::array<int32_t, 2> levels{};
+};
+
+}  // namespace
+
+std::string_view content_encoding_to_string(ContentEncoding encoding) noexcept {
+    using namespace std::string_view_literals;
+    switch (encoding) {
+        case ContentEncoding::Gzip:
+            return "gzip"sv;
+        case ContentEncoding::Deflate:
+            return "deflate"sv;
+        default:
+            return "identity"sv;
+    }
+}
+
+ContentEncoding negotiate_encoding(std::string_view accept_encoding) noexcept {
+    LOG_TRACE("http::negotiate_encoding()");
+    EncodingWeights weights = parse_accept_encoding(accept_encoding);
+
+    if (weights.gzip > 0 && weights.gzip >= weights.deflate) {
+        return ContentEncoding::Gzip;
+    }
+    if (weights.deflate > 0) {
+        return ContentEncoding::Deflate;
+    }
+    return ContentEncoding::Identity;
+}
+
+bool accepts_encoding(
+    std::string_view accept_encoding, ContentEncoding encoding) noexcept {
+    EncodingWeights weights = parse_accept_encoding(accept_encoding);
+    switch (encoding) {
+        case ContentEncoding::Gzip:
+            return weights.gzip > 0;
+        case ContentEncoding::Deflate:
+            return weights.deflate > 0;
+        default:
+            return true;
+    }
+}
+
+bool is_compressible(std::string_view content_type) noexcept {
+    std::string_view media_type =
+        trim(content_type.substr(0, content_type.find(';')));
+    return (media_type.size() > 5 &&
+               iequals(media_type.substr(0, 5), "text/")) ||
+           iequals(media_type, "application/json");
+}
+
+std::optional<std::string> compress(
+    std::string_view input, ContentEncoding encoding, int32_t level) {
+    LOG_TRACE("http::compress()");
+
+    z_stream* stream = Deflaters::local().get(encoding, level);
+    if (stream == nullptr) {
+        LOG_ERROR("Failed to initialize zlib deflater");
+        return std::nullopt;
+    }
+
+    std::string output(deflateBound(stream, input.size()), '\0');
+    stream->next_in =
+        reinterpret_cast<Bytef*>(const_cast<char*>(input.data()));
+    stream->avail_in = static_cast<uInt>(input.size());
+    stream->next_out = reinterpret_cast<Bytef*>(output.data());
+    stream->avail_out = static_cast<uInt>(output.size());
+
+    // deflateBound 만큼의 공간이면 한 번에 끝난다
+    if (deflate(stream, Z_FINISH) != Z_STREAM_END) {
+        LOG_ERROR("Failed to compress response body");
+        return std::nullopt;
+    }
+
+    output.resize(stream->total_out);
+    return std::optional(std::move(output));
+}
+
+std::optional<std::shared_ptr<const std::string>> CompressionCache::find(
+    const Key& key) {
+    auto entry = self.index.find(key);
+    if (entry == self.index.end()) {
+        return std::nullopt;
+    }
+
+    self.entries.splice(self.entries.begin(), self.entries, entry->second);
+    return entry->second->data;
+}
+
+void CompressionCache::insert(
+    const Key& key, std::shared_ptr<const std::string> data) {
+    LOG_TRACE("http::CompressionCache::insert()");
+
+    if (auto existing = self.index.find(key); existing != self.index.end()) {
+        self.used -= CompressionCache::cost(*existing->second);
+        self.entries.erase(existing->second);
+        self.index.erase(existing);
+    }
+
+    Entry entry{key, std::move(data)};
+    size_t entry_cost = CompressionCache::cost(entry);
+    if (entry_cost > self.capacity) {
+        return;
+    }
+
+    // 넣을 자리가 생길 때까지 가장 오래 쓰지 않은 항목부터 버린다
+    while (self.used + entry_cost > self.capacity) {
+        Entry& oldest = self.entries.back();
+        self.used -= CompressionCache::cost(oldest);
+        self.index.erase(oldest.key);
+        self.entries.pop_back();
+    }
+
+    self.entries.push_front(std::move(entry));
+    self.index.emplace(key, self.entries.begin());
+    self.used += entry_cost;
+}
+
+void Compressor::apply(
+    Response& response, ContentEncoding encoding, BodyHash& body_hash) const {
+    LOG_TRACE("http::Compressor::apply()");
+
+    // 파일은 워커에서 읽지 않도록 .gz 파일이 없으면 그대로 보낸다
+    if (response.http_code != HttpCode::Ok || !response.parts.empty() ||
+        response.file.has_value() || response.stream.has_value() ||
+        response.fields.contains("Content-Encoding")) {
+        return;
+    }
+
+    auto content_type = response.fields.find("Content-Type");
+    if (content_type == response.fields.end() ||
+        !is_compressible(content_type->second)) {
+        return;
+    }
+
+    uint64_t size = response.body.size();
+    if (size < self.min_size) {
+        return;
+    }
+
+    // 같은 URL 이라도 Accept-Encoding 에 따라 다른 본문이 나간다
+    response.fields["Vary"] = "Accept-Encoding";
+    if (encoding == ContentEncoding::Identity) {
+        return;
+    }
+
+    // ETag 와 같은 해시를 쓰므로 본문을 한 번만 읽는다
+    CompressionCache::Key key{body_hash.get(), size, encoding, self.level};
+    CompressionCache& cache = CompressionCache::local(self.cache_size);
+    std::optional<std::shared_ptr<const std::string>> cached = cache.find(key);
+
+    std::shared_ptr<const std::string> compressed;
+    if (cached.has_value()) {
+        compressed = std::move(cached.value());
+    } else {
+        std::optional<std::string> output =
+            compress(response.body, encoding, self.level);
+        if (!output.has_value()) {
+            return;
+        }
+        if (output->size() < size) {
+            compressed =
+                std::make_shared<const std::string>(std::move(output.value()));
+        }
+        cache.insert(key, compressed);
+    }
+
+    if (compressed == nullptr) {
+        return;
+    }
+
+    response.body = *compressed;
+    response.body_owner = std::move(compressed);
+    response.fields["Content-Encoding"] = content_encoding_to_string(encoding);
+    response.fields["Content-Length"] =
+        LengthText{}.format(response.body.size());
+
+    // 강한 ETag 는 표현마다 달라야 하므로 압축 방식을 붙인다
+    auto etag = response.fields.find("ETag");
+    if (etag != response.fields.end() && etag->second.ends_with('"')) {
+        etag->second.insert(etag->second.size() - 1, "-");
+        etag->second.insert(etag->second.size() - 1,
+            content_encoding_to_string(encoding));
+    }
+}
+
+}  // namespace http
@@ -0,0 +1,137 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <list>
+#include <memory>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include "response.hpp"
+
+namespace http {
+
+enum struct ContentEncoding : uint8_t {
+    Identity,
+    Gzip,
+    Deflate,
+};
+
+std::string_view content_encoding_to_string(ContentEncoding encoding) noexcept;
+
+/**
+ * Picks the coding to send from an `Accept-Encoding` value: gzip or deflate,
+ * whichever has the higher q-value (gzip on a tie), or identity when neither
+ * is acceptable.
+ */
+ContentEncoding negotiate_encoding(std::string_view accept_encoding) noexcept;
+
+// Accept-Encoding 이 이 압축을 받아들이는지
+bool accepts_encoding(
+    std::string_view accept_encoding, ContentEncoding encoding) noexcept;
+
+// 압축해서 이득이 있는 Content-Type 인지, text/* 와 JSON
+bool is_compressible(std::string_view content_type) noexcept;
+
+/**
+ * Compresses `input` in one pass with a deflater kept per thread. Returns
+ * nullopt when zlib fails.
+ */
+std::optional<std::string> compress(
+    std::string_view input, ContentEncoding encoding, int32_t level);
+
+/**
+ * Least recently used cache of compressed bodies keyed by the hash and size of
+ * the uncompressed content, the coding and the zlib level, bounded by the
+ * bytes it holds. The level is part of the key because every `Compressor` on
+ * a thread shares the cache. Bodies are shared, so one evicted while it is
+ * still being sent stays alive until the send completes. A body that did not
+ * get smaller is remembered as nullptr so it is not compressed again.
+ *
+ * Owned by one thread; nothing here is synchronised.
+ */
+class CompressionCache {
+public:
+    struct Key {
+        uint64_t hash;
+        uint64_t size;
+        ContentEncoding encoding;
+        int32_t level;
+
+        bool operator==(const Key&) const = default;
+    };
+
+    explicit CompressionCache(size_t capacity) noexcept : capacity(capacity) {}
+
+    CompressionCache(CompressionCache&) = delete;
+    CompressionCache& operator=(CompressionCache&) = delete;
+
+    // 스레드마다 하나, 용량은 처음 부를 때 정해진다
+    static CompressionCache& local(size_t capacity) {
+        thread_local CompressionCache cache(capacity);
+        return cache;
+    }
+
+    std::optional<std::shared_ptr<const std::string>> find(const Key& key);
+    void insert(const Key& key, std::shared_ptr<const std::string> data);
+
+private:
+    struct Entry {
+        Key key;
+        std::shared_ptr<const std::string> data;
+    };
+
+    struct KeyHash {
+        size_t operator()(const Key& key) const noexcept {
+            return static_cast<size_t>(
+                key.hash ^ (key.size * 0x9E3779B97F4A7C15ULL) ^
+                static_cast<uint64_t>(key.encoding) ^
+                (static_cast<uint64_t>(key.level) << 8));
+        }
+    };
+
+    static size_t cost(const Entry& entry) noexcept {
+        return sizeof(Entry) + (entry.data ? entry.data->size() : 0);
+    }
+
+private:
+    CompressionCache& self = *this;
+
+    std::list<Entry> entries;  // 앞쪽이 최근에 쓴 항목
+    std::unordered_map<Key, std::list<Entry>::iterator, KeyHash> index;
+    size_t capacity;
+    size_t used = 0;
+};
+
+/**
+ * Compresses eligible responses: 200s with an in-memory text or JSON body of
+ * at least `min_size` bytes. File bodies are left alone, since reading them
+ * would block the worker; static files use a `.gz` sibling instead.
+ * Compressed bodies come from the thread's `CompressionCache`, so a body
+ * already seen is never compressed again.
+ */
+class Compressor {
+public:
+    Compressor(int32_t level, size_t min_size, size_t cache_size) noexcept
+        : level(level), min_size(min_size), cache_size(cache_size) {}
+
+    Compressor(Compressor&) = delete;
+    Compressor& operator=(Compressor&) = delete;
+
+    /**
+     * Encodes the body of `response` with `encoding`, updating
+     * `Content-Encoding`, `Content-Length` and `ETag`, and marks eligible
+     * responses `Vary: Accept-Encoding` even when sent as is.
+     */
+    void apply(Response& response, ContentEncoding encoding,
+        BodyHash& body_hash) const;
+
+private:
+    Compressor& self = *this;
+
+    int32_t level;
+    size_t min_size;
+    size_t cache_size;
+};
+
+}  // namespace http
@@ -0,0 +1,157 @@
+#include "conditional.hpp"
+#include "hash.hpp"
+#include "http_date.hpp"
+#include "log.hpp"
+#include "string_utils.hpp"
+
+namespace http {
+
+namespace {
+
+std::string_view field_value(
+    const Response& response, const char* name) noexcept {
+    auto field = response.fields.find(name);
+    if (field == response.fields.end()) {
+        return {};
+    }
+    return field->second;
+}
+
+// 약한 비교이므로 W/ 를 떼고 따옴표 안의 값만 비교한다
+std::string_view opaque_tag(std::string_view etag) noexcept {
+    if (etag.starts_with("W/")) {
+        etag.remove_prefix(2);
+    }
+    return etag;
+}
+
+}  // namespace
+
+bool etag_matches(
+    std::string_view if_none_match, std::string_view etag) noexcept {
+    LOG_TRACE("http::etag_matches()");
+
+    if_none_match = trim(if_none_match);
+    if (if_none_match == "*") {
+        return !etag.empty();
+    }
+
+    std::string_view wanted = opaque_tag(etag);
+    if (wanted.empty()) {
+        return false;
+    }
+
+    // 태그 안에 쉼표가 올 수 있으므로 따옴표 단위로 읽는다
+    while (!if_none_match.empty()) {
+        size_t begin = if_none_match.find('"');
+        if (begin == std::string_view::npos) {
+            return false;
+        }
+        size_t end = if_none_match.find('"', begin + 1);
+        if (end == std::string_view::npos) {
+            return false;
+        }
+
+        if (if_none_match.substr(begin, end - begin + 1) == wanted) {
+            return true;
+        }
+        if_none_match.remove_prefix(end + 1);
+    }
+    return false;
+}
+
+bool is_not_modified(std::string_view etag, std::string_view last_modified,
+    std::optional<std::string_view> if_none_match,
+    std::optional<std::string_view> if_modified_since) noexcept {
+    LOG_TRACE("http::is_not_modified()");
+
+    if (if_none_match.has_value()) {
+        return etag_matches(if_none_match.value(), etag);
+    }
+    if (!if_modified_since.has_value() || last_modified.empty()) {
+        return false;
+    }
+
+    std::optional<int64_t> since =
+        parse_http_date(trim(if_modified_since.value()));
+    std::optional<int64_t> modified = parse_http_date(last_modified);
+    return since.has_value() && modified.has_value() &&
+           modified.value() <= since.value();
+}
+
+bool is_not_modified(const Response& response,
+    std::optional<std::string_view> if_none_match,
+    std::optional<std::string_view> if_modified_since) noexcept {
+    return is_not_modified(field_value(response, "ETag"),
+        field_value(response, "Last-Modified"), if_none_match,
+        if_modified_since);
+}
+
+void add_etag(Response& response, BodyHash& body_hash) {
+    LOG_TRACE("http::add_etag()");
+
+    if (response.http_code != HttpCode::Ok || response.file.has_value() ||
+        response.stream.has_value() || response.fields.contains("ETag")) {
+        return;
+    }
+
+    // 힙에 문자열을 만들지 않고 필드 값으로 바로 복사한다
+    response.fields.insert({"ETag", EtagText{}.format(body_hash.get())});
+}
+
+void make_not_modified(Response& response) {
+    LOG_TRACE("http::make_not_modified()");
+
+    // 304 에는 본문이 없으므로 본문을 설명하는 필드도 뺀다
+    response.http_code = HttpCode::NotModified;
+    response.body = {};
+    response.body_owner.reset();
+    response.file.reset();
+    response.parts.clear();
+    response.stream.reset();
+    response.fields.erase("Content-Length");
+    response.fields.erase("Content-Type");
+    response.fields.erase("Accept-Ranges");
+}
+
+size_t ValidatorCache::TargetHash::operator()(
+    std::string_view target) const noexcept {
+    return static_cast<size_t>(hash_bytes(target));
+}
+
+const ValidatorCache::Validators* ValidatorCache::find(std::string_view target,
+    ContentEncoding encoding,
+    std::chrono::steady_clock::time_point now) const noexcept {
+    auto entry = self.entries.find(target);
+    if (entry == self.entries.end()) {
+        return nullptr;
+    }
+
+    const Validators& validators =
+        entry->second[static_cast<size_t>(encoding)];
+    if (validators.expires <= now) {
+        return nullptr;
+    }
+    return &validators;
+}
+
+void ValidatorCache::store(std::string_view target, ContentEncoding encoding,
+    const Response& response, std::chrono::steady_clock::time_point expires) {
+    LOG_TRACE("http::ValidatorCache::store()");
+
+    Validators validators{std::string(field_value(response, "ETag")),
+        std::string(field_value(response, "Last-Modified")),
+        std::string(field_value(response, "Vary")), expires};
+
+    auto entry = self.entries.find(target);
+    if (entry == self.entries.end()) {
+        // 가득 차면 비우고 다시 채운다, 오래된 항목은 어차피 만료된다
+        if (self.entries.size() >= VALIDATOR_CACHE_MAX_ENTRIES) {
+            self.entries.clear();
+        }
+        entry = self.entries.emplace(std::string(target), Codings{}).first;
+    }
+    entry->second[static_cast<size_t>(encoding)] = std::move(validators);
+}
+
+}  // namespace http
@@ -0,0 +1,109 @@
+#pragma once
+#include <array>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <format>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include "compression.hpp"
+#include "response.hpp"
+
+namespace http {
+
+static constexpr size_t VALIDATOR_CACHE_MAX_ENTRIES = 4096;
+static constexpr size_t ETAG_LENGTH = 18;  // 따옴표와 16 자리 16진수
+
+// 해시로 만든 강한 ETag 를 힙 대신 쓰는 버퍼, 따옴표를 포함한다
+struct EtagText {
+    std::array<char, ETAG_LENGTH> buffer;
+
+    std::string_view format(uint64_t hash) noexcept {
+        std::format_to(buffer.data(), "\"{:016x}\"", hash);
+        return std::string_view(buffer.data(), buffer.size());
+    }
+};
+
+/**
+ * Weak comparison of `etag` against an `If-None-Match` list; "*" matches
+ * any tag.
+ */
+bool etag_matches(
+    std::string_view if_none_match, std::string_view etag) noexcept;
+
+/**
+ * Whether a client holding a representation with these validators can be
+ * answered 304. `If-Modified-Since` is only looked at when there is no
+ * `If-None-Match`, and an unparsable date is ignored.
+ */
+bool is_not_modified(std::string_view etag, std::string_view last_modified,
+    std::optional<std::string_view> if_none_match,
+    std::optional<std::string_view> if_modified_since) noexcept;
+
+bool is_not_modified(const Response& response,
+    std::optional<std::string_view> if_none_match,
+    std::optional<std::string_view> if_modified_since) noexcept;
+
+/**
+ * Gives a 200 with an in-memory body a strong ETag from the hash of its body,
+ * unless it already has one. Files get theirs where they are opened.
+ */
+void add_etag(Response& response, BodyHash& body_hash);
+
+/**
+ * Turns `response` into a 304 without a body, keeping its validators.
+ */
+void make_not_modified(Response& response);
+
+/**
+ * Validators of the last 200 the handler returned for each request target and
+ * negotiated content coding, per thread, so a matching revalidation is
+ * answered before the handler runs. Keeping codings apart means a `-gzip`
+ * ETag is never matched for an identity response. Entries expire after the
+ * configured time to live.
+ */
+class ValidatorCache {
+public:
+    struct Validators {
+        std::string etag;
+        std::string last_modified;
+        std::string vary;  // 304 도 같은 Vary 를 보내야 한다
+        std::chrono::steady_clock::time_point expires;
+    };
+
+    ValidatorCache() = default;
+    ValidatorCache(ValidatorCache&) = delete;
+    ValidatorCache& operator=(ValidatorCache&) = delete;
+
+    static ValidatorCache& local() noexcept {
+        thread_local ValidatorCache cache;
+        return cache;
+    }
+
+    const Validators* find(std::string_view target, ContentEncoding encoding,
+        std::chrono::steady_clock::time_point now) const noexcept;
+    void store(std::string_view target, ContentEncoding encoding,
+        const Response& response,
+        std::chrono::steady_clock::time_point expires);
+
+private:
+    // string_view 로 바로 찾을 수 있게 한다
+    struct TargetHash {
+        using is_transparent = void;
+        size_t operator()(std::string_view target) const noexcept;
+    };
+
+    // 압축 방식마다 하나, 저장하지 않은 칸은 이미 만료되어 있다
+    using Codings = std::array<Validators,
+        static_cast<size_t>(ContentEncoding::Deflate) + 1>;
+
+private:
+    ValidatorCache& self = *this;
+
+    std::unordered_map<std::string, Codings, TargetHash, std::equal_to<>>
+        entries;
+};
+
+}  // namespace http
@@ -1,6 +1,7 @@
 #pragma once
 #include <string_view>
 #include "log.hpp"
+#include "string_utils.hpp"
 
 namespace http {
 
@@ -111,4 +112,48 @@ ContentTypeCategory get_content_type_category(ContentType content_type) {
     }
 }
 
-}  // namespace http
\ No newline at end of file
+/**
+ * Maps a file extension, without the dot, to its content type. Unknown
+ * extensions are served as `Bin`.
+ */
+ContentType content_type_from_extension(std::string_view extension) {
+    LOG_TRACE("http::content_type_from_extension()");
+    struct Entry {
+        std::string_view extension;
+        ContentType content_type;
+    };
+    static constexpr Entry ENTRIES[] = {
+        {"html", ContentType::Html},
+        {"htm", ContentType::Html},
+        {"js", ContentType::Javascript},
+        {"mjs", ContentType::Javascript},
+        {"css", ContentType::Css},
+        {"txt", ContentType::Text},
+        {"csv", ContentType::Csv},
+        {"json", ContentType::JSON},
+        {"xml", ContentType::Xml},
+        {"pdf", ContentType::Pdf},
+        {"jpg", ContentType::Jpeg},
+        {"jpeg", ContentType::Jpeg},
+        {"png", ContentType::Png},
+        {"svg", ContentType::Svg},
+        {"webp", ContentType::Webp},
+        {"ico", ContentType::Ico},
+        {"mp3", ContentType::Mp3},
+        {"wav", ContentType::Wav},
+        {"weba", ContentType::Weba},
+        {"mp4", ContentType::Mp4},
+        {"mpeg", ContentType::Mpeg},
+        {"mpg", ContentType::Mpeg},
+        {"webm", ContentType::Webm},
+    };
+
+    for (const Entry& entry : ENTRIES) {
+        if (iequals(entry.extension, extension)) {
+            return entry.content_type;
+        }
+    }
+    return ContentType::Bin;
+}
+
+}  // namespace http
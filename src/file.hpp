@@ -0,0 +1,263 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <filesystem>
+#include <memory>
+#include <string_view>
+#include "log.hpp"
+
+#ifdef _WIN32
+    #ifndef WIN32_LEAN_AND_MEAN
+        #define WIN32_LEAN_AND_MEAN
+    #endif
+
+    #include <windows.h>
+
+    #include <fcntl.h>
+    #include <io.h>
+    #include <sys/stat.h>
+#else
+    #include <cerrno>
+
+    #include <fcntl.h>
+    #include <sys/mman.h>
+    #include <sys/stat.h>
+    #include <unistd.h>
+#endif
+
+namespace http {
+
+/**
+ * Read-only file opened for sending. Shared between every response that
+ * sends from it and closed when the last one is done, so the descriptor
+ * outlives any send still in flight.
+ */
+class File {
+public:
+    File(File&) = delete;
+    File& operator=(File&) = delete;
+
+    ~File() {
+#ifdef _WIN32
+        _close(self.fd);
+#else
+        ::close(self.fd);
+#endif
+    }
+
+    /**
+     * Opens a regular file, or returns nullptr when it does not exist, is not
+     * a regular file or cannot be read.
+     */
+    static std::shared_ptr<const File> open(const std::filesystem::path& path) {
+        LOG_TRACE("http::File::open()");
+#ifdef _WIN32
+        int fd = _wopen(path.c_str(), _O_RDONLY | _O_BINARY);
+        if (fd == -1) {
+            return nullptr;
+        }
+
+        struct _stat64 status;
+        if (_fstat64(fd, &status) != 0 || (status.st_mode & _S_IFREG) == 0) {
+            _close(fd);
+            return nullptr;
+        }
+
+        // _stat64 의 st_ino 는 항상 0 이므로 파일 인덱스를 쓴다
+        BY_HANDLE_FILE_INFORMATION information{};
+        GetFileInformationByHandle(
+            reinterpret_cast<HANDLE>(_get_osfhandle(fd)), &information);
+        uint64_t inode =
+            (static_cast<uint64_t>(information.nFileIndexHigh) << 32) |
+            information.nFileIndexLow;
+#else
+        int fd = ::open(path.c_str(), O_RDONLY | O_CLOEXEC);
+        if (fd == -1) {
+            return nullptr;
+        }
+
+        struct stat status;
+        if (::fstat(fd, &status) != 0 || !S_ISREG(status.st_mode)) {
+            ::close(fd);
+            return nullptr;
+        }
+        uint64_t inode = static_cast<uint64_t>(status.st_ino);
+#endif
+
+#ifdef _WIN32
+        int64_t modified_time =
+            static_cast<int64_t>(status.st_mtime) * 1'000'000'000;
+#else
+        int64_t modified_time =
+            static_cast<int64_t>(status.st_mtim.tv_sec) * 1'000'000'000 +
+            status.st_mtim.tv_nsec;
+#endif
+
+        return std::shared_ptr<const File>(new File(fd,
+            static_cast<uint64_t>(status.st_size), modified_time, inode));
+    }
+
+    int descriptor() const noexcept {
+        return self.fd;
+    }
+
+    uint64_t size() const noexcept {
+        return self.file_size;
+    }
+
+    // 마지막 수정 시각, Unix 초
+    int64_t modified() const noexcept {
+        return self.modified_time / 1'000'000'000;
+    }
+
+    // 같은 초 안의 수정도 구분할 수 있는 나노초 단위 수정 시각
+    int64_t modified_nanoseconds() const noexcept {
+        return self.modified_time;
+    }
+
+    // 같은 파일 시스템 안에서 파일을 구분하는 번호 (Windows 는 파일 인덱스)
+    uint64_t inode() const noexcept {
+        return self.inode_number;
+    }
+
+    /**
+     * Copies `length` bytes at `offset` into `out`. Only used where the file
+     * cannot be sent straight from the page cache.
+     */
+    bool read(uint64_t offset, size_t length, char* out) const noexcept {
+#ifdef _WIN32
+        HANDLE handle = reinterpret_cast<HANDLE>(_get_osfhandle(self.fd));
+        while (length > 0) {
+            OVERLAPPED overlapped{};
+            overlapped.Offset = static_cast<DWORD>(offset);
+            overlapped.OffsetHigh = static_cast<DWORD>(offset >> 32);
+
+            DWORD bytes_read = 0;
+            DWORD chunk = static_cast<DWORD>(
+                length < 0x40000000 ? length : 0x40000000);
+            if (!ReadFile(handle, out, chunk, &bytes_read, &overlapped) ||
+                bytes_read == 0) {
+                return false;
+            }
+            offset += bytes_read;
+            out += bytes_read;
+            length -= bytes_read;
+        }
+#else
+        while (length > 0) {
+            ssize_t bytes_read =
+                ::pread(self.fd, out, length, static_cast<off_t>(offset));
+            if (bytes_read <= 0) {
+                if (bytes_read < 0 && errno == EINTR) {
+                    continue;
+                }
+                return false;
+            }
+            offset += static_cast<uint64_t>(bytes_read);
+            out += bytes_read;
+            length -= static_cast<size_t>(bytes_read);
+        }
+#endif
+        return true;
+    }
+
+private:
+    File(int fd, uint64_t file_size, int64_t modified_time,
+        uint64_t inode_number) noexcept
+        : fd(fd),
+          file_size(file_size),
+          modified_time(modified_time),
+          inode_number(inode_number) {}
+
+private:
+    File& self = *this;
+
+    int fd;
+    uint64_t file_size;
+    int64_t modified_time;  // Unix 나노초
+    uint64_t inode_number;
+};
+
+/**
+ * Read-only memory mapping of a whole file, unmapped when the last response
+ * that sends from it is done. Sent straight from the mapping without
+ * copying, and unlike a `FileBody` it can be compressed and hashed in place.
+ */
+class MappedFile {
+public:
+    MappedFile(MappedFile&) = delete;
+    MappedFile& operator=(MappedFile&) = delete;
+
+    ~MappedFile() {
+        if (self.data == nullptr) {
+            return;
+        }
+#ifdef _WIN32
+        UnmapViewOfFile(self.data);
+#else
+        ::munmap(self.data, self.size);
+#endif
+    }
+
+    /**
+     * Maps `file`, or returns nullptr when it cannot be mapped.
+     */
+    static std::shared_ptr<const MappedFile> map(const File& file) {
+        LOG_TRACE("http::MappedFile::map()");
+        size_t size = static_cast<size_t>(file.size());
+        // 빈 파일은 매핑할 수 없으니 빈 본문으로 둔다
+        if (size == 0) {
+            return std::shared_ptr<const MappedFile>(
+                new MappedFile(nullptr, 0));
+        }
+
+#ifdef _WIN32
+        HANDLE handle =
+            reinterpret_cast<HANDLE>(_get_osfhandle(file.descriptor()));
+        HANDLE mapping =
+            CreateFileMappingW(handle, nullptr, PAGE_READONLY, 0, 0, nullptr);
+        if (mapping == nullptr) {
+            return nullptr;
+        }
+        // 뷰가 남아 있는 동안 매핑 객체는 닫아도 된다
+        void* data = MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, size);
+        CloseHandle(mapping);
+        if (data == nullptr) {
+            return nullptr;
+        }
+#else
+        void* data =
+            ::mmap(nullptr, size, PROT_READ, MAP_SHARED, file.descriptor(), 0);
+        if (data == MAP_FAILED) {
+            return nullptr;
+        }
+#endif
+        return std::shared_ptr<const MappedFile>(new MappedFile(data, size));
+    }
+
+    std::string_view bytes() const noexcept {
+        return std::string_view(static_cast<const char*>(self.data), self.size);
+    }
+
+private:
+    MappedFile(void* data, size_t size) noexcept : data(data), size(size) {}
+
+private:
+    MappedFile& self = *this;
+
+    void* data;
+    size_t size;
+};
+
+/**
+ * `length` bytes of `file` from `offset`, sent without copying where the
+ * platform allows.
+ */
+struct FileBody {
+    std::shared_ptr<const File> file;
+    uint64_t offset = 0;
+    uint64_t length = 0;
+};
+
+}  // namespace http
@@ -0,0 +1,108 @@
+#pragma once
+
+#include <bit>
+#include <cstdint>
+#include <cstring>
+#include <string_view>
+
+namespace http {
+
+namespace detail {
+
+static constexpr uint64_t XXH_PRIME1 = 0x9E3779B185EBCA87ULL;
+static constexpr uint64_t XXH_PRIME2 = 0xC2B2AE3D27D4EB4FULL;
+static constexpr uint64_t XXH_PRIME3 = 0x165667B19E3779F9ULL;
+static constexpr uint64_t XXH_PRIME4 = 0x85EBCA77C2B2AE63ULL;
+static constexpr uint64_t XXH_PRIME5 = 0x27D4EB2F165667C5ULL;
+
+inline uint64_t read_u64(const char* p) noexcept {
+    uint64_t value;
+    std::memcpy(&value, p, sizeof(value));
+    if constexpr (std::endian::native == std::endian::big) {
+        value = std::byteswap(value);
+    }
+    return value;
+}
+
+inline uint32_t read_u32(const char* p) noexcept {
+    uint32_t value;
+    std::memcpy(&value, p, sizeof(value));
+    if constexpr (std::endian::native == std::endian::big) {
+        value = std::byteswap(value);
+    }
+    return value;
+}
+
+constexpr uint64_t xxh_round(uint64_t acc, uint64_t input) noexcept {
+    acc += input * XXH_PRIME2;
+    acc = std::rotl(acc, 31);
+    return acc * XXH_PRIME1;
+}
+
+constexpr uint64_t xxh_merge(uint64_t acc, uint64_t value) noexcept {
+    acc ^= xxh_round(0, value);
+    return acc * XXH_PRIME1 + XXH_PRIME4;
+}
+
+}  // namespace detail
+
+/**
+ * XXH64 of `data`. Fast and well distributed but not cryptographic: good for
+ * ETags and cache keys, not for anything an attacker must not forge.
+ */
+inline uint64_t hash_bytes(std::string_view data, uint64_t seed = 0) noexcept {
+    using namespace detail;
+    const char* p = data.data();
+    const char* end = p + data.size();
+    uint64_t hash;
+
+    if (data.size() >= 32) {
+        uint64_t v1 = seed + XXH_PRIME1 + XXH_PRIME2;
+        uint64_t v2 = seed + XXH_PRIME2;
+        uint64_t v3 = seed;
+        uint64_t v4 = seed - XXH_PRIME1;
+
+        // 32 바이트씩 네 갈래로 나눠 섞는다
+        do {
+            v1 = xxh_round(v1, read_u64(p));
+            v2 = xxh_round(v2, read_u64(p + 8));
+            v3 = xxh_round(v3, read_u64(p + 16));
+            v4 = xxh_round(v4, read_u64(p + 24));
+            p += 32;
+        } while (end - p >= 32);
+
+        hash = std::rotl(v1, 1) + std::rotl(v2, 7) + std::rotl(v3, 12) +
+               std::rotl(v4, 18);
+        hash = xxh_merge(hash, v1);
+        hash = xxh_merge(hash, v2);
+        hash = xxh_merge(hash, v3);
+        hash = xxh_merge(hash, v4);
+    } else {
+        hash = seed + XXH_PRIME5;
+    }
+
+    hash += static_cast<uint64_t>(data.size());
+
+    for (; end - p >= 8; p += 8) {
+        hash ^= xxh_round(0, read_u64(p));
+        hash = std::rotl(hash, 27) * XXH_PRIME1 + XXH_PRIME4;
+    }
+    if (end - p >= 4) {
+        hash ^= static_cast<uint64_t>(read_u32(p)) * XXH_PRIME1;
+        hash = std::rotl(hash, 23) * XXH_PRIME2 + XXH_PRIME3;
+        p += 4;
+    }
+    for (; p < end; ++p) {
+        hash ^= static_cast<uint64_t>(static_cast<uint8_t>(*p)) * XXH_PRIME5;
+        hash = std::rotl(hash, 11) * XXH_PRIME1;
+    }
+
+    hash ^= hash >> 33;
+    hash *= XXH_PRIME2;
+    hash ^= hash >> 29;
+    hash *= XXH_PRIME3;
+    hash ^= hash >> 32;
+    return hash;
+}
+
+}  // namespace http
@@ -0,0 +1,227 @@
+#pragma once
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <memory_resource>
+#include <optional>
+#include <span>
+#include <string_view>
+#include <vector>
+#include "arena.hpp"
+#include "log.hpp"
+#include "string_utils.hpp"
+
+namespace http {
+
+static constexpr size_t INLINE_FIELD_COUNT = 16;
+
+// 파싱할 때 미리 분류해 두는 자주 쓰는 헤더
+enum struct FieldId : uint8_t {
+    Unknown,
+    Host,
+    Connection,
+    ContentLength,
+    ContentType,
+    TransferEncoding,
+    Accept,
+    AcceptEncoding,
+    Cookie,
+    UserAgent,
+    Expect,
+    Range,
+    IfRange,
+    IfNoneMatch,
+    IfModifiedSince,
+    Count,
+};
+
+std::string_view field_id_to_string(FieldId id) {
+    LOG_TRACE("http::field_id_to_string()");
+    using namespace std::string_view_literals;
+    switch (id) {
+        case FieldId::Host:
+            return "Host"sv;
+        case FieldId::Connection:
+            return "Connection"sv;
+        case FieldId::ContentLength:
+            return "Content-Length"sv;
+        case FieldId::ContentType:
+            return "Content-Type"sv;
+        case FieldId::TransferEncoding:
+            return "Transfer-Encoding"sv;
+        case FieldId::Accept:
+            return "Accept"sv;
+        case FieldId::AcceptEncoding:
+            return "Accept-Encoding"sv;
+        case FieldId::Cookie:
+            return "Cookie"sv;
+        case FieldId::UserAgent:
+            return "User-Agent"sv;
+        case FieldId::Expect:
+            return "Expect"sv;
+        case FieldId::Range:
+            return "Range"sv;
+        case FieldId::IfRange:
+            return "If-Range"sv;
+        case FieldId::IfNoneMatch:
+            return "If-None-Match"sv;
+        case FieldId::IfModifiedSince:
+            return "If-Modified-Since"sv;
+        default:
+            return ""sv;
+    }
+}
+
+/**
+ * Case-insensitive lookup of a well-known field name. Names are bucketed by
+ * length first, so most unknown names are rejected without a comparison.
+ */
+constexpr FieldId classify_field(std::string_view name) noexcept {
+    switch (name.size()) {
+        case 4:
+            return iequals(name, "Host") ? FieldId::Host : FieldId::Unknown;
+        case 5:
+            return iequals(name, "Range") ? FieldId::Range : FieldId::Unknown;
+        case 6:
+            if (iequals(name, "Accept")) return FieldId::Accept;
+            if (iequals(name, "Cookie")) return FieldId::Cookie;
+            if (iequals(name, "Expect")) return FieldId::Expect;
+            return FieldId::Unknown;
+        case 8:
+            return iequals(name, "If-Range") ? FieldId::IfRange
+                                             : FieldId::Unknown;
+        case 10:
+            if (iequals(name, "Connection")) return FieldId::Connection;
+            if (iequals(name, "User-Agent")) return FieldId::UserAgent;
+            return FieldId::Unknown;
+        case 12:
+            return iequals(name, "Content-Type") ? FieldId::ContentType
+                                                 : FieldId::Unknown;
+        case 13:
+            return iequals(name, "If-None-Match") ? FieldId::IfNoneMatch
+                                                  : FieldId::Unknown;
+        case 14:
+            return iequals(name, "Content-Length") ? FieldId::ContentLength
+                                                   : FieldId::Unknown;
+        case 15:
+            return iequals(name, "Accept-Encoding") ? FieldId::AcceptEncoding
+                                                    : FieldId::Unknown;
+        case 17:
+            if (iequals(name, "Transfer-Encoding")) {
+                return FieldId::TransferEncoding;
+            }
+            if (iequals(name, "If-Modified-Since")) {
+                return FieldId::IfModifiedSince;
+            }
+            return FieldId::Unknown;
+        default:
+            return FieldId::Unknown;
+    }
+}
+
+struct HeaderField {
+    FieldId id;
+    std::string_view name;
+    std::string_view value;
+};
+
+/**
+ * Request header table. The first `INLINE_FIELD_COUNT` fields live inline so
+ * a typical request needs no allocation, the rest in the current `Arena`;
+ * well-known fields are found through
+ * an index by `FieldId`, other names by a case-insensitive linear search.
+ * When a field repeats, lookups return the first occurrence.
+ */
+class HeaderFields {
+public:
+    void add(FieldId id, std::string_view name, std::string_view value) {
+        HeaderField field{id, name, value};
+
+        if (count < INLINE_FIELD_COUNT) {
+            inline_fields[count] = field;
+        } else {
+            // 인라인 공간을 넘으면 전부 아레나로 옮긴다
+            if (overflow.empty()) {
+                overflow.reserve(INLINE_FIELD_COUNT * 2);
+                overflow.assign(inline_fields.begin(), inline_fields.end());
+            }
+            overflow.push_back(field);
+        }
+
+        uint8_t& position = positions[static_cast<size_t>(id)];
+        if (id != FieldId::Unknown && position == 0) {
+            position = static_cast<uint8_t>(count + 1);
+        }
+        ++count;
+    }
+
+    std::optional<std::string_view> find(FieldId id) const noexcept {
+        uint8_t position = positions[static_cast<size_t>(id)];
+        if (id == FieldId::Unknown || position == 0) {
+            return std::nullopt;
+        }
+        return all()[position - 1].value;
+    }
+
+    std::optional<std::string_view> find(std::string_view name) const noexcept {
+        FieldId id = classify_field(name);
+        if (id != FieldId::Unknown) {
+            return find(id);
+        }
+
+        for (const HeaderField& field : all()) {
+            if (field.id == FieldId::Unknown && iequals(field.name, name)) {
+                return field.value;
+            }
+        }
+        return std::nullopt;
+    }
+
+    bool contains(FieldId id) const noexcept {
+        return positions[static_cast<size_t>(id)] != 0;
+    }
+
+    bool contains(std::string_view name) const noexcept {
+        return find(name).has_value();
+    }
+
+    std::span<const HeaderField> all() const noexcept {
+        if (!overflow.empty()) {
+            return std::span<const HeaderField>(overflow);
+        }
+        return std::span<const HeaderField>(inline_fields.data(), count);
+    }
+
+    auto begin() const noexcept {
+        return all().begin();
+    }
+
+    auto end() const noexcept {
+        return all().end();
+    }
+
+    size_t size() const noexcept {
+        return count;
+    }
+
+    bool empty() const noexcept {
+        return count == 0;
+    }
+
+    void clear() noexcept {
+        count = 0;
+        positions.fill(0);
+        overflow.clear();
+    }
+
+private:
+    // Request 와 함께 복사되므로 self 참조를 두지 않는다
+    std::array<HeaderField, INLINE_FIELD_COUNT> inline_fields{};
+    std::pmr::vector<HeaderField> overflow{Arena::current()};
+    // FieldId 별 첫 필드의 위치 + 1, 없으면 0
+    std::array<uint8_t, static_cast<size_t>(FieldId::Count)> positions{};
+    size_t count = 0;
+};
+
+}  // namespace http
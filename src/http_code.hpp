@@ -1,4 +1,5 @@
 #pragma once
+#include <array>
 #include <iostream>
 #include <string_view>
 #include "log.hpp"
@@ -74,7 +75,37 @@ enum struct HttpCode {
     NetworkAuthenticationRequired = 511
 };
 
-std::string http_code_to_string(HttpCode http_code) {
+// 모든 상태 코드, 상태 줄 표를 미리 만들 때 쓴다
+constexpr std::array<HttpCode, 61> HTTP_CODES{
+    HttpCode::Continue, HttpCode::SwitchingProtocol, HttpCode::EarlyHints,
+    HttpCode::Ok, HttpCode::Created, HttpCode::Accepted,
+    HttpCode::NonAuthoritativeInformation, HttpCode::NoContent,
+    HttpCode::ResetContent, HttpCode::PartialContent, HttpCode::MultiStatus,
+    HttpCode::AlreadyReported, HttpCode::IMUsed, HttpCode::MultipleChoices,
+    HttpCode::MovedPermanently, HttpCode::Found, HttpCode::SeeOther,
+    HttpCode::NotModified, HttpCode::Unused, HttpCode::TemporaryRedirect,
+    HttpCode::PermanentRedirect, HttpCode::BadRequest, HttpCode::Unauthorized,
+    HttpCode::PaymentRequired, HttpCode::Forbidden, HttpCode::NotFound,
+    HttpCode::MethodNotAllowed, HttpCode::NotAcceptable,
+    HttpCode::ProxyAuthenticationRequired, HttpCode::RequestTimeout,
+    HttpCode::Conflict, HttpCode::Gone, HttpCode::LengthRequired,
+    HttpCode::PreconditionFailed, HttpCode::ContentTooLarge,
+    HttpCode::URITooLong, HttpCode::UnsupportedMediaType,
+    HttpCode::RangeNotSatisfiable, HttpCode::ExpectationFailed,
+    HttpCode::ImaTeapot, HttpCode::MisdirectedRequest,
+    HttpCode::UnprocessableContent, HttpCode::Locked,
+    HttpCode::FailedDependency, HttpCode::TooEarly, HttpCode::UpgradeRequired,
+    HttpCode::PreconditionRequired, HttpCode::TooManyRequests,
+    HttpCode::RequestHeaderFieldsTooLarge, HttpCode::UnavailableForLegalReasons,
+    HttpCode::InternalServerError, HttpCode::NotImplemented,
+    HttpCode::BadGateway, HttpCode::ServiceUnavailable,
+    HttpCode::GatewayTimeout, HttpCode::HTTPVersionNotSupported,
+    HttpCode::VariantAlsoNegotiates, HttpCode::InsufficientStorage,
+    HttpCode::LoopDetected, HttpCode::NotExtended,
+    HttpCode::NetworkAuthenticationRequired,
+};
+
+std::string_view http_code_to_string(HttpCode http_code) {
     LOG_TRACE("http::http_code_to_string()");
 
     switch (http_code) {
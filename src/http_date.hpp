@@ -0,0 +1,96 @@
+#pragma once
+
+#include <array>
+#include <chrono>
+#include <cstdint>
+#include <format>
+#include <optional>
+#include <string>
+#include <string_view>
+#include "log.hpp"
+
+namespace http {
+
+static constexpr std::array<std::string_view, 7> HTTP_DATE_WEEKDAYS = {
+    "Sun", "Mon", "Tue", "Wed", "Thu", "Fri", "Sat"};
+static constexpr std::array<std::string_view, 12> HTTP_DATE_MONTHS = {
+    "Jan", "Feb", "Mar", "Apr", "May", "Jun",
+    "Jul", "Aug", "Sep", "Oct", "Nov", "Dec"};
+
+/**
+ * Formats Unix seconds as an IMF-fixdate, e.g.
+ * "Sun, 06 Nov 1994 08:49:37 GMT".
+ */
+std::string format_http_date(int64_t unix_seconds) {
+    LOG_TRACE("http::format_http_date()");
+    std::chrono::sys_seconds time{std::chrono::seconds(unix_seconds)};
+    std::chrono::sys_days days = std::chrono::floor<std::chrono::days>(time);
+    std::chrono::year_month_day ymd{days};
+    std::chrono::hh_mm_ss hms{time - days};
+
+    // 로케일과 무관하게 영어 요일과 월 이름을 쓴다
+    return std::format("{}, {:02} {} {:04} {:02}:{:02}:{:02} GMT",
+        HTTP_DATE_WEEKDAYS[std::chrono::weekday(days).c_encoding()],
+        static_cast<uint32_t>(ymd.day()),
+        HTTP_DATE_MONTHS[static_cast<uint32_t>(ymd.month()) - 1],
+        static_cast<int32_t>(ymd.year()), hms.hours().count(),
+        hms.minutes().count(), hms.seconds().count());
+}
+
+/**
+ * Parses an IMF-fixdate into Unix seconds. The obsolete RFC 850 and asctime
+ * forms are not accepted; callers ignore a date they cannot parse.
+ */
+std::optional<int64_t> parse_http_date(std::string_view date) noexcept {
+    LOG_TRACE("http::parse_http_date()");
+    // "Sun, 06 Nov 1994 08:49:37 GMT"
+    if (date.size() != 29 || date[3] != ',' || date[4] != ' ' ||
+        date[7] != ' ' || date[11] != ' ' || date[16] != ' ' ||
+        date[19] != ':' || date[22] != ':' || date.substr(25) != " GMT") {
+        return std::nullopt;
+    }
+
+    auto number = [date](size_t offset, size_t length) -> int32_t {
+        int32_t value = 0;
+        for (char c : date.substr(offset, length)) {
+            if (c < '0' || c > '9') {
+                return -1;
+            }
+            value = value * 10 + (c - '0');
+        }
+        return value;
+    };
+
+    int32_t day = number(5, 2);
+    int32_t year = number(12, 4);
+    int32_t hour = number(17, 2);
+    int32_t minute = number(20, 2);
+    int32_t second = number(23, 2);
+
+    uint32_t month = 0;
+    while (month < HTTP_DATE_MONTHS.size() &&
+           HTTP_DATE_MONTHS[month] != date.substr(8, 3)) {
+        ++month;
+    }
+
+    if (day < 0 || year < 0 || hour < 0 || hour > 23 || minute < 0 ||
+        minute > 59 || second < 0 || second > 60 ||
+        month == HTTP_DATE_MONTHS.size()) {
+        return std::nullopt;
+    }
+
+    std::chrono::year_month_day ymd{std::chrono::year(year),
+        std::chrono::month(month + 1),
+        std::chrono::day(static_cast<uint32_t>(day))};
+    if (!ymd.ok()) {
+        return std::nullopt;
+    }
+
+    std::chrono::sys_seconds time = std::chrono::sys_days(ymd) +
+                                    std::chrono::hours(hour) +
+                                    std::chrono::minutes(minute) +
+                                    std::chrono::seconds(second);
+    return time.time_since_epoch().count();
+}
+
+}  // namespace http
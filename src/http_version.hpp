@@ -3,16 +3,22 @@
 
 namespace http {
 
-enum struct HttpVersion { Http1_1, Unknown };
+enum struct HttpVersion { Http1_0, Http1_1, Unknown };
 
 HttpVersion parse_http_version(std::string_view raw_version) {
     LOG_TRACE("http::parse_http_version()");
-    std::string_view version_literal(
-        raw_version.begin() + 4, raw_version.end());
+    if (raw_version.size() < 5) {
+        return HttpVersion::Unknown;
+    }
+
+    // "HTTP/" 다음의 버전 번호만 비교한다
+    std::string_view version_literal = raw_version.substr(5);
 
     using namespace std::string_view_literals;
     if (version_literal == "1.1"sv) {
         return HttpVersion::Http1_1;
+    } else if (version_literal == "1.0"sv) {
+        return HttpVersion::Http1_0;
     } else {
         return HttpVersion::Unknown;
     }
@@ -22,6 +28,8 @@ std::string_view http_version_to_string(HttpVersion http_version) {
     LOG_TRACE("http::http_version_to_string()");
     using namespace std::string_view_literals;
     switch (http_version) {
+        case HttpVersion::Http1_0:
+            return "HTTP/1.0"sv;
         case HttpVersion::Http1_1:
             return "HTTP/1.1"sv;
         default:
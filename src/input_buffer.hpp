@@ -0,0 +1,119 @@
+#pragma once
+
+#include <algorithm>
+#include <cstddef>
+#include <cstring>
+#include <memory>
+#include <span>
+#include <string_view>
+#include "log.hpp"
+
+namespace http {
+
+static constexpr size_t INPUT_BUFFER_SIZE = 4096;
+static constexpr size_t INPUT_BUFFER_RETAIN_SIZE = 64 * 1024;
+
+/**
+ * Growable per-connection receive buffer. Bytes are appended at the end and
+ * consumed from the front; storage is kept across keep-alive requests and
+ * only shrinks back once a large request has been fully consumed.
+ */
+class InputBuffer {
+public:
+    InputBuffer() = default;
+    InputBuffer(InputBuffer&) = delete;
+    InputBuffer& operator=(InputBuffer&) = delete;
+
+    std::string_view data() const noexcept {
+        return std::string_view(self.storage.get() + self.begin, self.size());
+    }
+
+    std::span<char> mutable_data() noexcept {
+        return std::span<char>(self.storage.get() + self.begin, self.size());
+    }
+
+    size_t size() const noexcept {
+        return self.end - self.begin;
+    }
+
+    bool empty() const noexcept {
+        return self.begin == self.end;
+    }
+
+    /**
+     * Returns at least `min_size` writable bytes after the buffered data.
+     * Call `commit()` with the number of bytes actually written.
+     */
+    std::span<char> prepare(size_t min_size) {
+        if (self.capacity - self.end < min_size) {
+            self.reserve(min_size);
+        }
+        return std::span<char>(
+            self.storage.get() + self.end, self.capacity - self.end);
+    }
+
+    void commit(size_t size) noexcept {
+        self.end += size;
+    }
+
+    void append(std::string_view bytes) {
+        std::span<char> space = self.prepare(bytes.size());
+        std::memcpy(space.data(), bytes.data(), bytes.size());
+        self.commit(bytes.size());
+    }
+
+    void consume(size_t size) noexcept {
+        self.begin += size;
+
+        if (self.begin == self.end) {
+            self.begin = 0;
+            self.end = 0;
+
+            // 큰 요청 뒤에는 기본 크기로 되돌려 유휴 연결의 메모리를 줄인다
+            if (self.capacity > INPUT_BUFFER_RETAIN_SIZE) {
+                self.storage.reset();
+                self.capacity = 0;
+            }
+        }
+    }
+
+private:
+    void reserve(size_t min_size) {
+        size_t used = self.size();
+
+        // 앞쪽에 소비된 공간이 충분하면 데이터를 당겨온다
+        if (self.capacity - used >= min_size && self.storage != nullptr) {
+            std::memmove(
+                self.storage.get(), self.storage.get() + self.begin, used);
+            self.begin = 0;
+            self.end = used;
+            return;
+        }
+
+        size_t new_capacity = std::max(self.capacity * 2, INPUT_BUFFER_SIZE);
+        while (new_capacity - used < min_size) {
+            new_capacity *= 2;
+        }
+
+        std::unique_ptr<char[]> new_storage =
+            std::make_unique_for_overwrite<char[]>(new_capacity);
+        if (used > 0) {
+            std::memcpy(new_storage.get(), self.storage.get() + self.begin, used);
+        }
+
+        self.storage = std::move(new_storage);
+        self.capacity = new_capacity;
+        self.begin = 0;
+        self.end = used;
+    }
+
+private:
+    InputBuffer& self = *this;
+
+    std::unique_ptr<char[]> storage;
+    size_t capacity = 0;
+    size_t begin = 0;
+    size_t end = 0;
+};
+
+}  // namespace http
@@ -0,0 +1,422 @@
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <cerrno>
+#include <cstdint>
+#include <cstring>
+#include <format>
+#include <span>
+#include <stdexcept>
+
+#include <linux/io_uring.h>
+#include <sys/mman.h>
+#include <sys/socket.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+
+#include "log.hpp"
+
+namespace http {
+
+/**
+ * Minimal io_uring ring built directly on the raw syscalls, so the project
+ * does not depend on liburing. One instance is owned by exactly one worker
+ * thread; nothing here is thread-safe.
+ */
+class IoUring {
+public:
+    IoUring() = default;
+    IoUring(IoUring&) = delete;
+    IoUring& operator=(IoUring&) = delete;
+
+    ~IoUring() {
+        LOG_TRACE("http::~IoUring()");
+
+        if (self.buffers != nullptr) {
+            munmap(self.buffers, self.buffers_size);
+        }
+        if (self.buffer_ring != nullptr) {
+            munmap(self.buffer_ring, self.buffer_ring_size);
+        }
+        if (self.sqes != nullptr) {
+            munmap(self.sqes, self.sqes_size);
+        }
+        if (self.cq_ring_ptr != nullptr && self.cq_ring_ptr != self.sq_ring_ptr) {
+            munmap(self.cq_ring_ptr, self.cq_ring_size);
+        }
+        if (self.sq_ring_ptr != nullptr) {
+            munmap(self.sq_ring_ptr, self.sq_ring_size);
+        }
+        if (self.fd != -1) {
+            ::close(self.fd);
+        }
+    }
+
+    void init(uint32_t entries) {
+        LOG_TRACE("http::IoUring::init()");
+
+        io_uring_params params{};
+        params.flags = IORING_SETUP_COOP_TASKRUN;
+
+        self.fd = static_cast<int>(
+            syscall(__NR_io_uring_setup, entries, &params));
+
+        if (self.fd < 0 && errno == EINVAL) {
+            // IORING_SETUP_COOP_TASKRUN 은 5.19 이상에서만 지원된다
+            params = io_uring_params{};
+            self.fd = static_cast<int>(
+                syscall(__NR_io_uring_setup, entries, &params));
+        }
+
+        if (self.fd < 0) {
+            throw std::runtime_error(
+                std::format("Cannot create io_uring: {}", std::strerror(errno)));
+        }
+
+        self.sq_ring_size =
+            params.sq_off.array + params.sq_entries * sizeof(uint32_t);
+        self.cq_ring_size =
+            params.cq_off.cqes + params.cq_entries * sizeof(io_uring_cqe);
+
+        if (params.features & IORING_FEAT_SINGLE_MMAP) {
+            self.sq_ring_size = std::max(self.sq_ring_size, self.cq_ring_size);
+            self.cq_ring_size = self.sq_ring_size;
+        }
+
+        self.sq_ring_ptr = mmap(nullptr, self.sq_ring_size,
+            PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, self.fd,
+            IORING_OFF_SQ_RING);
+
+        if (self.sq_ring_ptr == MAP_FAILED) {
+            self.sq_ring_ptr = nullptr;
+            throw std::runtime_error(std::format(
+                "Cannot map io_uring submission queue: {}", std::strerror(errno)));
+        }
+
+        if (params.features & IORING_FEAT_SINGLE_MMAP) {
+            self.cq_ring_ptr = self.sq_ring_ptr;
+        } else {
+            self.cq_ring_ptr = mmap(nullptr, self.cq_ring_size,
+                PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, self.fd,
+                IORING_OFF_CQ_RING);
+
+            if (self.cq_ring_ptr == MAP_FAILED) {
+                self.cq_ring_ptr = nullptr;
+                throw std::runtime_error(
+                    std::format("Cannot map io_uring completion queue: {}",
+                        std::strerror(errno)));
+            }
+        }
+
+        self.sqes_size = params.sq_entries * sizeof(io_uring_sqe);
+        void* sqes = mmap(nullptr, self.sqes_size, PROT_READ | PROT_WRITE,
+            MAP_SHARED | MAP_POPULATE, self.fd, IORING_OFF_SQES);
+
+        if (sqes == MAP_FAILED) {
+            throw std::runtime_error(std::format(
+                "Cannot map io_uring entries: {}", std::strerror(errno)));
+        }
+        self.sqes = static_cast<io_uring_sqe*>(sqes);
+
+        char* sq = static_cast<char*>(self.sq_ring_ptr);
+        self.sq_head = reinterpret_cast<uint32_t*>(sq + params.sq_off.head);
+        self.sq_tail = reinterpret_cast<uint32_t*>(sq + params.sq_off.tail);
+        self.sq_mask = *reinterpret_cast<uint32_t*>(sq + params.sq_off.ring_mask);
+        self.sq_entries = params.sq_entries;
+
+        // SQ index 배열은 항상 sqes 와 1:1 로 대응시킨다
+        uint32_t* sq_array =
+            reinterpret_cast<uint32_t*>(sq + params.sq_off.array);
+        for (uint32_t i = 0; i < self.sq_entries; ++i) {
+            sq_array[i] = i;
+        }
+
+        char* cq = static_cast<char*>(self.cq_ring_ptr);
+        self.cq_head = reinterpret_cast<uint32_t*>(cq + params.cq_off.head);
+        self.cq_tail = reinterpret_cast<uint32_t*>(cq + params.cq_off.tail);
+        self.cq_mask = *reinterpret_cast<uint32_t*>(cq + params.cq_off.ring_mask);
+        self.cqes = reinterpret_cast<io_uring_cqe*>(cq + params.cq_off.cqes);
+
+        self.local_sq_tail = *self.sq_tail;
+        self.submitted_tail = self.local_sq_tail;
+    }
+
+    /**
+     * Registers `count` buffers of `size` bytes as provided buffer group
+     * `group`. `count` must be a power of two.
+     */
+    void register_buffer_ring(uint16_t group, uint16_t count, uint32_t size) {
+        LOG_TRACE("http::IoUring::register_buffer_ring()");
+
+        self.buffer_ring_size = count * sizeof(io_uring_buf);
+        void* ring = mmap(nullptr, self.buffer_ring_size,
+            PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+
+        if (ring == MAP_FAILED) {
+            throw std::runtime_error(std::format(
+                "Cannot allocate io_uring buffer ring: {}", std::strerror(errno)));
+        }
+        self.buffer_ring = static_cast<io_uring_buf_ring*>(ring);
+
+        io_uring_buf_reg reg{};
+        reg.ring_addr = reinterpret_cast<uint64_t>(self.buffer_ring);
+        reg.ring_entries = count;
+        reg.bgid = group;
+
+        if (syscall(__NR_io_uring_register, self.fd, IORING_REGISTER_PBUF_RING,
+                &reg, 1) < 0) {
+            throw std::runtime_error(std::format(
+                "Cannot register io_uring buffer ring: {}", std::strerror(errno)));
+        }
+
+        // 페이지 정렬된 메모리여야 mbind 로 NUMA 노드를 옮길 수 있다
+        self.buffers_size = static_cast<size_t>(count) * size;
+        void* buffers = mmap(nullptr, self.buffers_size, PROT_READ | PROT_WRITE,
+            MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+
+        if (buffers == MAP_FAILED) {
+            throw std::runtime_error(std::format(
+                "Cannot allocate io_uring buffers: {}", std::strerror(errno)));
+        }
+
+        self.buffers = static_cast<char*>(buffers);
+        self.buffer_size = size;
+        self.buffer_mask = count - 1;
+
+        for (uint16_t id = 0; id < count; ++id) {
+            self.push_buffer(id);
+        }
+        self.publish_buffers();
+    }
+
+    char* buffer(uint16_t id) noexcept {
+        return self.buffers + static_cast<size_t>(id) * self.buffer_size;
+    }
+
+    /**
+     * Whole provided buffer region, e.g. to place it on a NUMA node.
+     */
+    std::span<char> buffer_memory() noexcept {
+        return std::span<char>(self.buffers, self.buffers_size);
+    }
+
+    /**
+     * Hands a consumed provided buffer back to the kernel.
+     */
+    void recycle_buffer(uint16_t id) noexcept {
+        self.push_buffer(id);
+        self.publish_buffers();
+    }
+
+    /**
+     * Returns a zeroed SQE, flushing queued entries to the kernel first when
+     * the submission queue is full.
+     */
+    io_uring_sqe* get_sqe() {
+        uint32_t head =
+            std::atomic_ref<uint32_t>(*self.sq_head).load(std::memory_order_acquire);
+
+        if (self.local_sq_tail - head >= self.sq_entries) {
+            self.submit(0);
+            head = std::atomic_ref<uint32_t>(*self.sq_head)
+                       .load(std::memory_order_acquire);
+            if (self.local_sq_tail - head >= self.sq_entries) {
+                return nullptr;
+            }
+        }
+
+        io_uring_sqe* sqe = &self.sqes[self.local_sq_tail & self.sq_mask];
+        std::memset(sqe, 0, sizeof(io_uring_sqe));
+        ++self.local_sq_tail;
+        return sqe;
+    }
+
+    /**
+     * Submits every queued SQE in a single `io_uring_enter` and optionally
+     * waits for `wait_nr` completions.
+     */
+    int32_t submit(uint32_t wait_nr) {
+        std::atomic_ref<uint32_t>(*self.sq_tail)
+            .store(self.local_sq_tail, std::memory_order_release);
+
+        uint32_t to_submit = self.local_sq_tail - self.submitted_tail;
+        self.submitted_tail = self.local_sq_tail;
+
+        if (to_submit == 0 && wait_nr == 0) {
+            return 0;
+        }
+
+        uint32_t flags = wait_nr > 0 ? IORING_ENTER_GETEVENTS : 0;
+        int32_t result = static_cast<int32_t>(syscall(__NR_io_uring_enter,
+            self.fd, to_submit, wait_nr, flags, nullptr, 0));
+
+        return result < 0 ? -errno : result;
+    }
+
+    /**
+     * Calls `func(const io_uring_cqe&)` for every available completion and
+     * marks them consumed.
+     */
+    template <typename F>
+    uint32_t for_each_cqe(F&& func) {
+        uint32_t head = *self.cq_head;
+        uint32_t tail =
+            std::atomic_ref<uint32_t>(*self.cq_tail).load(std::memory_order_acquire);
+        uint32_t count = 0;
+
+        for (; head != tail; ++head, ++count) {
+            func(self.cqes[head & self.cq_mask]);
+        }
+
+        std::atomic_ref<uint32_t>(*self.cq_head)
+            .store(head, std::memory_order_release);
+        return count;
+    }
+
+    bool prep_multishot_accept(int fd, uint64_t user_data) {
+        io_uring_sqe* sqe = self.get_sqe();
+        if (sqe == nullptr) {
+            return false;
+        }
+        sqe->opcode = IORING_OP_ACCEPT;
+        sqe->fd = fd;
+        sqe->ioprio = IORING_ACCEPT_MULTISHOT;
+        // 워커가 직접 sendfile 할 때 블록되지 않도록 non-blocking 으로 받는다
+        sqe->accept_flags = SOCK_CLOEXEC | SOCK_NONBLOCK;
+        sqe->user_data = user_data;
+        return true;
+    }
+
+    bool prep_multishot_recv(int fd, uint16_t group, uint64_t user_data) {
+        io_uring_sqe* sqe = self.get_sqe();
+        if (sqe == nullptr) {
+            return false;
+        }
+        sqe->opcode = IORING_OP_RECV;
+        sqe->fd = fd;
+        sqe->ioprio = IORING_RECV_MULTISHOT;
+        sqe->flags = IOSQE_BUFFER_SELECT;
+        sqe->buf_group = group;
+        sqe->user_data = user_data;
+        return true;
+    }
+
+    bool prep_send(int fd, const void* data, size_t size, uint64_t user_data) {
+        io_uring_sqe* sqe = self.get_sqe();
+        if (sqe == nullptr) {
+            return false;
+        }
+        sqe->opcode = IORING_OP_SEND;
+        sqe->fd = fd;
+        sqe->addr = reinterpret_cast<uint64_t>(data);
+        sqe->len = static_cast<uint32_t>(size);
+        sqe->msg_flags = MSG_NOSIGNAL;
+        sqe->user_data = user_data;
+        return true;
+    }
+
+    bool prep_sendmsg(int fd, const msghdr* message, uint64_t user_data) {
+        io_uring_sqe* sqe = self.get_sqe();
+        if (sqe == nullptr) {
+            return false;
+        }
+        sqe->opcode = IORING_OP_SENDMSG;
+        sqe->fd = fd;
+        sqe->addr = reinterpret_cast<uint64_t>(message);
+        sqe->len = 1;
+        sqe->msg_flags = MSG_NOSIGNAL;
+        sqe->user_data = user_data;
+        return true;
+    }
+
+    // `target` 을 user_data 로 건 작업을 취소한다
+    bool prep_cancel(uint64_t target, uint64_t user_data) {
+        io_uring_sqe* sqe = self.get_sqe();
+        if (sqe == nullptr) {
+            return false;
+        }
+        sqe->opcode = IORING_OP_ASYNC_CANCEL;
+        sqe->fd = -1;
+        sqe->addr = target;
+        sqe->user_data = user_data;
+        return true;
+    }
+
+    // 완료 수를 세지 않는 순수 타이머
+    bool prep_timeout(const __kernel_timespec* timeout, uint64_t user_data) {
+        io_uring_sqe* sqe = self.get_sqe();
+        if (sqe == nullptr) {
+            return false;
+        }
+        sqe->opcode = IORING_OP_TIMEOUT;
+        sqe->fd = -1;
+        sqe->addr = reinterpret_cast<uint64_t>(timeout);
+        sqe->len = 1;
+        sqe->user_data = user_data;
+        return true;
+    }
+
+    bool prep_poll(int fd, uint32_t events, uint64_t user_data) {
+        io_uring_sqe* sqe = self.get_sqe();
+        if (sqe == nullptr) {
+            return false;
+        }
+        sqe->opcode = IORING_OP_POLL_ADD;
+        sqe->fd = fd;
+        sqe->poll32_events = events;
+        sqe->user_data = user_data;
+        return true;
+    }
+
+private:
+    void push_buffer(uint16_t id) noexcept {
+        // C++ 에서는 __DECLARE_FLEX_ARRAY 의 빈 구조체 때문에 `bufs` 의 오프셋이
+        // 어긋나므로 링 시작 주소를 직접 배열로 사용한다
+        io_uring_buf* bufs = reinterpret_cast<io_uring_buf*>(self.buffer_ring);
+        io_uring_buf* buf = &bufs[self.buffer_tail & self.buffer_mask];
+        buf->addr = reinterpret_cast<uint64_t>(self.buffer(id));
+        buf->len = self.buffer_size;
+        buf->bid = id;
+        ++self.buffer_tail;
+    }
+
+    void publish_buffers() noexcept {
+        std::atomic_ref<uint16_t>(self.buffer_ring->tail)
+            .store(self.buffer_tail, std::memory_order_release);
+    }
+
+private:
+    IoUring& self = *this;
+
+    int fd = -1;
+
+    void* sq_ring_ptr = nullptr;
+    void* cq_ring_ptr = nullptr;
+    size_t sq_ring_size = 0;
+    size_t cq_ring_size = 0;
+
+    io_uring_sqe* sqes = nullptr;
+    size_t sqes_size = 0;
+    uint32_t* sq_head = nullptr;
+    uint32_t* sq_tail = nullptr;
+    uint32_t sq_mask = 0;
+    uint32_t sq_entries = 0;
+    uint32_t local_sq_tail = 0;
+    uint32_t submitted_tail = 0;
+
+    uint32_t* cq_head = nullptr;
+    uint32_t* cq_tail = nullptr;
+    uint32_t cq_mask = 0;
+    io_uring_cqe* cqes = nullptr;
+
+    io_uring_buf_ring* buffer_ring = nullptr;
+    size_t buffer_ring_size = 0;
+    uint16_t buffer_tail = 0;
+    uint16_t buffer_mask = 0;
+    uint32_t buffer_size = 0;
+    char* buffers = nullptr;
+    size_t buffers_size = 0;
+};
+
+}  // namespace http
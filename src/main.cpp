@@ -10,27 +10,18 @@ int main() {
             .port = 3000,
         };
         http::Server server = http::Server(config);
-        server.on_receive(
-            [&server](http::Request&& request) -> std::vector<http::Response> {
-                LOG_INFO("{} {}", request.method_to_string(), request.route);
-                LOG_INFO("body: {}", request.body);
-                LOG_INFO("");
-
-                std::vector<http::Response> responses{};
-
-                http::Response response =
-                    http::Response::create(server, request, http::HttpCode::Ok,
-                        http::ContentType::Text, "Hello World!");
-
-                responses.push_back(response);
-
-                return responses;
-            });
 
         LOG_INFO(
             "Server is listening at http://{}:{}", config.host, config.port);
 
-        server.listen();
+        server.serve([&server](http::Request&& request) {
+            LOG_INFO("{} {}", request.method_to_string(), request.route);
+            LOG_INFO("body: {}", request.body);
+            LOG_INFO("");
+
+            return http::Response::create(server, request, http::HttpCode::Ok,
+                http::ContentType::Text, "Hello World!");
+        });
     } catch (std::exception& e) {
         LOG_ERROR("{}", e.what());
         return 1;
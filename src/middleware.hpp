@@ -0,0 +1,155 @@
+#pragma once
+#include <concepts>
+#include <cstddef>
+#include <functional>
+#include <optional>
+#include <tuple>
+#include <type_traits>
+#include <utility>
+#include "request.hpp"
+#include "response.hpp"
+
+namespace http {
+
+/**
+ * Handler for `Server::serve()` that runs `handler` inside a fixed stack of
+ * middlewares. Everything is resolved at compile time, so the compiler can
+ * inline the whole stack into one function: there is no `std::function`, no
+ * indirect call and no allocation per layer.
+ *
+ * The first middleware is the outermost. Each one is either
+ * - callable as `Response(Request&&, Next& next)`, calling
+ *   `next(std::move(request))` to run the rest of the stack, or not, to answer
+ *   by itself; or
+ * - an object with a `std::optional<Response> before(Request&)` hook, which
+ *   answers by itself when it returns a response, and/or a
+ *   `void after(Response&)` hook, which runs on the response from the rest of
+ *   the stack.
+ *
+ * Build one with `pipeline()`.
+ */
+template <typename Handler, typename... Middlewares>
+class Pipeline {
+public:
+    Pipeline(Handler handler, Middlewares... middlewares)
+        : handler(std::move(handler)), middlewares(std::move(middlewares)...) {}
+
+    Response operator()(Request&& request) {
+        return call<0>(std::move(request));
+    }
+
+private:
+    template <typename M>
+    static constexpr bool has_before =
+        requires(M& middleware, Request& request) {
+            {
+                middleware.before(request)
+            } -> std::convertible_to<std::optional<Response>>;
+        };
+
+    template <typename M>
+    static constexpr bool has_after =
+        requires(M& middleware, Response& response) {
+            middleware.after(response);
+        };
+
+    template <size_t I>
+    Response call(Request&& request) {
+        if constexpr (I == sizeof...(Middlewares)) {
+            return std::invoke(handler, std::move(request));
+        } else {
+            using Middleware =
+                std::tuple_element_t<I, std::tuple<Middlewares...>>;
+            Middleware& middleware = std::get<I>(middlewares);
+            // 나머지 스택, 인라인되도록 람다로 넘긴다
+            auto next = [this](Request&& passed) {
+                return call<I + 1>(std::move(passed));
+            };
+
+            if constexpr (has_before<Middleware> || has_after<Middleware>) {
+                if constexpr (has_before<Middleware>) {
+                    std::optional<Response> response =
+                        middleware.before(request);
+                    if (response.has_value()) {
+                        return std::move(response.value());
+                    }
+                }
+
+                return Pipeline::call_after(
+                    middleware, next, std::move(request));
+            } else {
+                static_assert(
+                    std::is_invocable_r_v<Response, Middleware&, Request&&,
+                        decltype(next)&>,
+                    "Middleware must take (Request&&, next) or have "
+                    "before/after hooks");
+                return std::invoke(middleware, std::move(request), next);
+            }
+        }
+    }
+
+    // 반환 경로가 하나뿐이라 응답을 옮기지 않고 그 자리에서 돌려준다
+    template <typename Middleware, typename Next>
+    static Response call_after(
+        Middleware& middleware, Next& next, Request&& request) {
+        Response response = next(std::move(request));
+        if constexpr (has_after<Middleware>) {
+            middleware.after(response);
+        }
+        return response;
+    }
+
+private:
+    // 복사해서 서버에 넘기므로 self 참조를 두지 않는다
+    Handler handler;
+    std::tuple<Middlewares...> middlewares;
+};
+
+/**
+ * Wraps `handler` in `middlewares`, the first of them outermost.
+ */
+template <typename Handler, typename... Middlewares>
+Pipeline<std::decay_t<Handler>, std::decay_t<Middlewares>...> pipeline(
+    Handler&& handler, Middlewares&&... middlewares) {
+    return Pipeline<std::decay_t<Handler>, std::decay_t<Middlewares>...>(
+        std::forward<Handler>(handler),
+        std::forward<Middlewares>(middlewares)...);
+}
+
+/**
+ * Middleware that runs `hook(Request&)` before the rest of the stack; a
+ * returned response is sent instead of running it.
+ */
+template <typename F>
+struct BeforeHook {
+    F hook;
+
+    std::optional<Response> before(Request& request) {
+        return std::invoke(hook, request);
+    }
+};
+
+/**
+ * Middleware that runs `hook(Response&)` on the response from the rest of
+ * the stack.
+ */
+template <typename F>
+struct AfterHook {
+    F hook;
+
+    void after(Response& response) {
+        std::invoke(hook, response);
+    }
+};
+
+template <typename F>
+BeforeHook<std::decay_t<F>> before(F&& hook) {
+    return BeforeHook<std::decay_t<F>>{std::forward<F>(hook)};
+}
+
+template <typename F>
+AfterHook<std::decay_t<F>> after(F&& hook) {
+    return AfterHook<std::decay_t<F>>{std::forward<F>(hook)};
+}
+
+}  // namespace http
@@ -0,0 +1,515 @@
+#pragma once
+
+#include <algorithm>
+#include <charconv>
+#include <cstddef>
+#include <cstring>
+#include <exception>
+#include <memory>
+#include <optional>
+#include <span>
+#include <string_view>
+#include <vector>
+#include "buffer_pool.hpp"
+#include "file.hpp"
+#include "log.hpp"
+#include "response.hpp"
+
+#include <sys/uio.h>
+
+namespace http {
+
+// chunked 조각 앞에 남겨 두는 자리, 16진수 길이 8자리와 CRLF
+static constexpr size_t CHUNK_HEAD_SIZE = 10;
+static constexpr std::string_view LAST_CHUNK = "0\r\n\r\n";
+
+/**
+ * Per-connection send queue. Response heads are written into fixed-size
+ * blocks from the thread's `BufferPool` that never move, so an in-flight send
+ * may point into them while more is appended; bodies are queued by reference
+ * and never copied, shared bodies together with their owner, file bodies as
+ * a descriptor range for `sendfile`, streamed bodies one pool buffer at a
+ * time as they are produced, framed as chunks when their length is unknown.
+ * `gather()` exposes the front of the queue as iovecs up to the next file or
+ * through the next stream chunk, `front_file()` that file once it reaches the
+ * front, and `consume()` drops what the kernel accepted.
+ */
+class OutputQueue {
+public:
+    OutputQueue() = default;
+    OutputQueue(OutputQueue&) = delete;
+    OutputQueue& operator=(OutputQueue&) = delete;
+
+    ~OutputQueue() {
+        self.clear();
+    }
+
+    /**
+     * Returns at least `min_size` contiguous writable bytes. Call `commit()`
+     * with the number of bytes actually written.
+     */
+    std::span<char> prepare(size_t min_size) {
+        if (self.blocks.empty() ||
+            self.blocks.back().capacity - self.blocks.back().used < min_size) {
+            self.add_block(min_size);
+        }
+
+        Block& block = self.blocks.back();
+        return std::span<char>(
+            block.data + block.used, block.capacity - block.used);
+    }
+
+    void commit(size_t size) {
+        if (size == 0) {
+            return;
+        }
+
+        Block& block = self.blocks.back();
+        char* data = block.data + block.used;
+        block.used += size;
+        self.queued += size;
+
+        // 바로 앞 조각에 이어지면 iovec 을 늘리기만 한다
+        if (!self.segments.empty()) {
+            Segment& last = self.segments.back();
+            if (last.kind == SegmentKind::Owned &&
+                static_cast<char*>(last.iov.iov_base) + last.iov.iov_len ==
+                    data) {
+                last.iov.iov_len += size;
+                return;
+            }
+        }
+        self.segments.push_back(
+            Segment{iovec{data, size}, SegmentKind::Owned});
+    }
+
+    void append(std::string_view bytes) {
+        std::span<char> space = self.prepare(bytes.size());
+        std::memcpy(space.data(), bytes.data(), bytes.size());
+        self.commit(bytes.size());
+    }
+
+    /**
+     * Queues `bytes` without copying. They must stay valid until sent.
+     */
+    void append_view(std::string_view bytes) {
+        if (bytes.empty()) {
+            return;
+        }
+        self.segments.push_back(
+            Segment{iovec{const_cast<char*>(bytes.data()), bytes.size()},
+                SegmentKind::View});
+        self.queued += bytes.size();
+    }
+
+    /**
+     * Queues `bytes` without copying and keeps `owner`, which holds them,
+     * alive until they are sent.
+     */
+    void append_shared(
+        std::string_view bytes, std::shared_ptr<const void> owner) {
+        if (bytes.empty()) {
+            return;
+        }
+        self.segments.push_back(
+            Segment{iovec{const_cast<char*>(bytes.data()), bytes.size()},
+                SegmentKind::Shared});
+        self.owners.push_back(std::move(owner));
+        self.queued += bytes.size();
+    }
+
+    /**
+     * Queues a file range. The queue keeps the file open until it is sent.
+     */
+    void append_file(FileBody body) {
+        if (body.length == 0) {
+            return;
+        }
+        size_t length = static_cast<size_t>(body.length);
+        self.segments.push_back(
+            Segment{iovec{nullptr, length}, SegmentKind::File});
+        self.files.push_back(std::move(body));
+        self.queued += length;
+    }
+
+    /**
+     * Queues a streamed body. Its first piece is produced right away and each
+     * next one once the previous piece has been sent. A body of unknown
+     * length is framed as chunks when `chunked`, otherwise it is sent as is
+     * and the connection has to close after it.
+     */
+    void append_stream(BodyStream body, bool chunked) {
+        if (body.length == 0) {
+            return;
+        }
+
+        std::optional<size_t> length;
+        if (body.length.has_value()) {
+            length = static_cast<size_t>(body.length.value());
+            self.queued += length.value();
+        }
+        self.streams.push_back(Stream{std::move(body),
+            BufferPool::local().acquire(), length.value_or(0),
+            !length.has_value() && chunked, !length.has_value()});
+        self.segments.push_back(
+            Segment{iovec{nullptr, 0}, SegmentKind::Stream});
+        self.pull(self.streams.back(), self.segments.back());
+        self.settle_streams();
+    }
+
+    /**
+     * Whether a stream ended before its length or threw. The connection can
+     * no longer keep its framing and has to be closed.
+     */
+    bool failed() const noexcept {
+        return self.stream_failed;
+    }
+
+    /**
+     * The file range at the front of the queue, or nullptr when the front is
+     * in memory.
+     */
+    const FileBody* front_file() const noexcept {
+        if (self.segments.empty() ||
+            self.segments.front().kind != SegmentKind::File) {
+            return nullptr;
+        }
+        return &self.files.front();
+    }
+
+    size_t size() const noexcept {
+        return self.queued;
+    }
+
+    // 실패한 스트림이 남아 있으면 연결을 닫을 때까지 비지 않는다
+    bool empty() const noexcept {
+        return self.queued == 0 && !self.stream_failed;
+    }
+
+    /**
+     * Fills `iovecs` from the front of the queue, stopping at the first file
+     * or after the first stream chunk, and returns how many were used.
+     */
+    size_t gather(std::span<iovec> iovecs) const noexcept {
+        size_t limit = std::min(iovecs.size(), self.segments.size());
+        size_t count = 0;
+        for (; count < limit; ++count) {
+            const Segment& segment = self.segments[count];
+            if (segment.kind == SegmentKind::File) {
+                break;
+            }
+            iovecs[count] = segment.iov;
+            // 스트림의 다음 조각은 아직 만들어지지 않았다
+            if (segment.kind == SegmentKind::Stream) {
+                return count + 1;
+            }
+        }
+        return count;
+    }
+
+    void consume(size_t size) noexcept {
+        self.queued -= size;
+
+        while (size > 0) {
+            Segment& segment = self.segments.front();
+            size_t taken = std::min(size, segment.iov.iov_len);
+
+            if (segment.kind == SegmentKind::File) {
+                self.files.front().offset += taken;
+                self.files.front().length -= taken;
+            } else {
+                if (segment.kind == SegmentKind::Owned) {
+                    self.blocks.front().released += taken;
+                }
+                segment.iov.iov_base =
+                    static_cast<char*>(segment.iov.iov_base) + taken;
+            }
+            segment.iov.iov_len -= taken;
+            size -= taken;
+
+            if (segment.kind == SegmentKind::Stream) {
+                self.settle_streams();
+                if (self.stream_failed) {
+                    return;
+                }
+                continue;
+            }
+
+            if (segment.iov.iov_len == 0) {
+                if (segment.kind == SegmentKind::File) {
+                    self.files.pop_front();
+                } else if (segment.kind == SegmentKind::Shared) {
+                    self.owners.pop_front();
+                }
+                self.segments.pop_front();
+            }
+            self.release_blocks();
+        }
+        self.settle_streams();
+    }
+
+    void clear() noexcept {
+        for (Block& block : self.blocks) {
+            self.free_block(block);
+        }
+        for (Stream& stream : self.streams) {
+            BufferPool::local().release(stream.buffer);
+        }
+        self.segments.clear();
+        self.files.clear();
+        self.owners.clear();
+        self.streams.clear();
+        self.blocks.clear();
+        self.queued = 0;
+        self.stream_failed = false;
+    }
+
+private:
+    /**
+     * First-in first-out list over a vector that keeps its capacity when it
+     * drains, so a steady connection stops allocating, unlike `std::deque`,
+     * which allocates and frees a node every few dozen entries.
+     */
+    template <typename T>
+    class Fifo {
+    public:
+        bool empty() const noexcept {
+            return head == items.size();
+        }
+
+        size_t size() const noexcept {
+            return items.size() - head;
+        }
+
+        T& front() noexcept {
+            return items[head];
+        }
+
+        const T& front() const noexcept {
+            return items[head];
+        }
+
+        T& back() noexcept {
+            return items.back();
+        }
+
+        const T& operator[](size_t index) const noexcept {
+            return items[head + index];
+        }
+
+        T* begin() noexcept {
+            return items.data() + head;
+        }
+
+        T* end() noexcept {
+            return items.data() + items.size();
+        }
+
+        void push_back(T item) {
+            // 앞쪽 빈 자리가 절반을 넘으면 당겨서 계속 자라지 않게 한다
+            if (head > 0 && head * 2 >= items.size()) {
+                items.erase(items.begin(),
+                    items.begin() + static_cast<ptrdiff_t>(head));
+                head = 0;
+            }
+            items.push_back(std::move(item));
+        }
+
+        void pop_front() noexcept {
+            // 가지고 있던 소유자나 파일은 바로 놓는다
+            items[head] = T{};
+            if (++head == items.size()) {
+                items.clear();
+                head = 0;
+            }
+        }
+
+        void pop_back() noexcept {
+            items.pop_back();
+            if (head == items.size()) {
+                items.clear();
+                head = 0;
+            }
+        }
+
+        void clear() noexcept {
+            items.clear();
+            head = 0;
+        }
+
+    private:
+        std::vector<T> items;
+        size_t head = 0;  // 아직 꺼내지 않은 첫 항목
+    };
+
+    struct Block {
+        char* data = nullptr;
+        size_t capacity = 0;
+        size_t used = 0;
+        size_t released = 0;  // 송신이 끝난 바이트 수
+    };
+
+    enum struct SegmentKind : uint8_t {
+        Owned,  // 블록 안의 데이터
+        View,   // 호출자가 가진 데이터
+        Shared, // owners 가 가진 데이터
+        File,   // files 의 파일 구간, iov 는 길이만 쓴다
+        Stream, // streams 의 버퍼에 만들어 둔 조각
+    };
+
+    struct Segment {
+        iovec iov;
+        SegmentKind kind;
+    };
+
+    struct Stream {
+        BodyStream body;
+        char* buffer;      // 풀 버퍼, 조각을 만들어 둔다
+        size_t remaining;  // 길이를 알 때 아직 만들지 않은 바이트 수
+        bool chunked;      // 조각마다 chunk 머리와 꼬리를 붙인다
+        bool open_ended;   // 길이를 모르고 next 가 0 을 돌려주면 끝난다
+        bool finished = false;
+    };
+
+    // 스트림의 다음 조각을 버퍼에 만들어 segment 가 가리키게 한다
+    bool pull(Stream& stream, Segment& segment) noexcept {
+        size_t head = stream.chunked ? CHUNK_HEAD_SIZE : 0;
+        size_t size = POOL_BUFFER_SIZE - head - (stream.chunked ? 2 : 0);
+        if (!stream.open_ended) {
+            size = std::min(size, stream.remaining);
+        }
+
+        char* data = stream.buffer + head;
+        size_t written = 0;
+        bool threw = false;
+        try {
+            written = stream.body.next(std::span<char>(data, size));
+        } catch (const std::exception& e) {
+            LOG_ERROR("Stream body threw: {}", e.what());
+            threw = true;
+        } catch (...) {
+            LOG_ERROR("Stream body threw");
+            threw = true;
+        }
+
+        if (threw || written > size ||
+            (written == 0 && !stream.open_ended)) {
+            self.stream_failed = true;
+            segment.iov = iovec{stream.buffer, 0};
+            return false;
+        }
+
+        if (written == 0) {
+            stream.finished = true;
+            segment.iov = iovec{stream.buffer, 0};
+            if (stream.chunked) {
+                std::memcpy(
+                    stream.buffer, LAST_CHUNK.data(), LAST_CHUNK.size());
+                segment.iov.iov_len = LAST_CHUNK.size();
+                self.queued += LAST_CHUNK.size();
+            }
+            return true;
+        }
+
+        if (!stream.open_ended) {
+            stream.remaining -= written;
+            stream.finished = stream.remaining == 0;
+            segment.iov = iovec{data, written};
+            return true;
+        }
+
+        // 길이를 16진수로 데이터 바로 앞에 붙인다
+        char* begin = data;
+        size_t length = written;
+        if (stream.chunked) {
+            char digits[8];
+            char* end =
+                std::to_chars(digits, digits + sizeof(digits), written, 16).ptr;
+            size_t count = static_cast<size_t>(end - digits);
+            begin = data - 2 - count;
+            std::memcpy(begin, digits, count);
+            std::memcpy(data - 2, "\r\n", 2);
+            std::memcpy(data + written, "\r\n", 2);
+            length = count + 2 + written + 2;
+        }
+        segment.iov = iovec{begin, length};
+        self.queued += length;
+        return true;
+    }
+
+    // 앞쪽 스트림이 보낸 조각 다음을 만들고, 끝난 스트림은 내려놓는다
+    void settle_streams() noexcept {
+        while (!self.segments.empty() &&
+               self.segments.front().kind == SegmentKind::Stream &&
+               self.segments.front().iov.iov_len == 0) {
+            Stream& stream = self.streams.front();
+            if (!stream.finished) {
+                // 다음 조각을 만들지 못했으면 failed() 로 알린다
+                if (!self.pull(stream, self.segments.front())) {
+                    return;
+                }
+                continue;
+            }
+            BufferPool::local().release(stream.buffer);
+            self.streams.pop_front();
+            self.segments.pop_front();
+        }
+    }
+
+    void add_block(size_t min_size) {
+        // 비어 있는 마지막 블록은 참조하는 조각이 없으므로 바꿔도 된다
+        if (!self.blocks.empty() && self.blocks.back().used == 0) {
+            self.free_block(self.blocks.back());
+            self.blocks.pop_back();
+        }
+
+        // 풀 버퍼보다 큰 헤더만 따로 할당한다
+        if (min_size <= POOL_BUFFER_SIZE) {
+            self.blocks.push_back(
+                Block{BufferPool::local().acquire(), POOL_BUFFER_SIZE});
+        } else {
+            self.blocks.push_back(Block{new char[min_size], min_size});
+        }
+    }
+
+    void free_block(Block& block) noexcept {
+        if (block.capacity == POOL_BUFFER_SIZE) {
+            BufferPool::local().release(block.data);
+        } else {
+            delete[] block.data;
+        }
+    }
+
+    void release_blocks() noexcept {
+        while (!self.blocks.empty()) {
+            Block& block = self.blocks.front();
+            if (block.released != block.used) {
+                return;
+            }
+
+            // 마지막 블록은 비우기만 하고 계속 쓴다
+            if (self.blocks.size() == 1) {
+                block.used = 0;
+                block.released = 0;
+                return;
+            }
+
+            self.free_block(block);
+            self.blocks.pop_front();
+        }
+    }
+
+private:
+    OutputQueue& self = *this;
+
+    Fifo<Block> blocks;      // 앞쪽 블록부터 송신된다
+    Fifo<Segment> segments;  // 송신할 순서대로 놓인 조각
+    Fifo<FileBody> files;    // File 조각의 파일, 순서대로 대응한다
+    // Shared 조각의 소유자, 순서대로 대응한다
+    Fifo<std::shared_ptr<const void>> owners;
+    Fifo<Stream> streams;  // Stream 조각의 본문, 순서대로 대응한다
+    size_t queued = 0;
+    bool stream_failed = false;
+};
+
+}  // namespace http
@@ -1,84 +1,89 @@
 #pragma once
-#include <algorithm>
+#include <memory_resource>
 #include <optional>
-#include <ranges>
+#include <span>
 #include <string_view>
-#include <unordered_map>
+#include "arena.hpp"
+#include "header_fields.hpp"
 #include "http_method.hpp"
 #include "http_version.hpp"
 #include "log.hpp"
+#include "request_parser.hpp"
 #include "string_utils.hpp"
 
 namespace http {
 
+/**
+ * Parsed HTTP request. Every view points into the receive buffer the request
+ * was parsed from and is only valid while that buffer is.
+ */
 struct Request {
     Method method;
     std::string_view request_target;
-    std::string_view route;
+    std::string_view route;  // '?' 앞의 경로
+    std::string_view query;  // '?' 뒤의 쿼리 문자열
     HttpVersion http_version;
-    std::unordered_map<std::string_view, std::string_view> fields;
+    HeaderFields fields;
     std::string_view body;
 
-    static std::optional<Request> create(std::string_view raw_input) {
+    static std::optional<Request> create(std::span<char> raw_input) {
         LOG_TRACE("http::Request::create()");
         Request request{};
+        RequestParser parser;
 
-        if (raw_input == "") {
+        ParseResult result = parser.parse(raw_input, request);
+        if (result.status != ParseStatus::Complete) {
             return std::nullopt;
         }
 
-        auto split_input =
-            split(raw_input, "\r\n") | std::views::split(std::string_view{""});
+        return std::optional(std::move(request));
+    }
 
-        auto header = split_input.front();
+    std::string_view method_to_string() const {
+        LOG_TRACE("http::Request::method_to_string()");
+        return http::method_to_string(method);
+    }
 
-        // Request line
-        // GET /route HTTP/1.1
-        std::string_view request_line = header.front();
-        auto split_request_line = split(request_line, ' ');
-        auto sv = std::ranges::to<std::vector>(split_request_line);
+    /**
+     * Memory for handler scratch: the connection's arena while the request is
+     * answered. It is not freed piece by piece but all at once after every
+     * response queued on the connection has been sent, so a response body
+     * may point into it. Outside a server worker this is the global
+     * allocator.
+     */
+    std::pmr::memory_resource* arena() const noexcept {
+        return Arena::current();
+    }
 
-        if (sv.size() != 3) {
-            return std::nullopt;
+    /**
+     * Whether the client wants the connection kept open after this request:
+     * HTTP/1.1 unless `Connection` lists `close`, HTTP/1.0 only when it
+     * lists `keep-alive`.
+     */
+    bool keep_alive() const noexcept {
+        bool keep = http_version != HttpVersion::Http1_0;
+        std::optional<std::string_view> connection =
+            fields.find(FieldId::Connection);
+        if (!connection.has_value()) {
+            return keep;
         }
-        request.method = parse_method(sv[0]);
-        request.route = sv[1];
-        request.http_version = parse_http_version(sv[2]);
-
-        // Fields
-        // field-name : field-value
-        auto fields = header | std::views::drop(1) |
-                      std::views::transform([](std::string_view field) {
-                          auto split_field = split(field, ':');
-                          auto field_name = split_field.front();
-                          auto temp_field_value =
-                              (split_field | std::views::drop(1)).front();
-                          auto field_value = temp_field_value.substr(
-                              temp_field_value.find_first_not_of(' '),
-                              temp_field_value.find_last_not_of(' '));
-
-                          return std::pair{field_name, field_value};
-                      });
-        request.fields.insert_range(fields);
 
-        // Body
-        request.body = (split_input | std::views::drop(1)).front().front();
-
-        return std::optional(request);
-    }
-
-    std::string_view method_to_string() {
-        LOG_TRACE("http::Request::method_to_string()");
-        return http::method_to_string(self.method);
+        for (std::string_view option : split(connection.value(), ',')) {
+            option = trim(option);
+            if (iequals(option, "close")) {
+                return false;
+            }
+            if (iequals(option, "keep-alive")) {
+                keep = true;
+            }
+        }
+        return keep;
     }
 
-    std::string_view http_version_to_string() {
+    std::string_view http_version_to_string() const {
         LOG_TRACE("http::Request::http_version_to_string()");
-        return http::http_version_to_string(self.http_version);
+        return http::http_version_to_string(http_version);
     }
-
-private:
-    Request& self = *this;
 };
 
-}  // namespace http
\ No newline at end of file
+}  // namespace http
@@ -0,0 +1,436 @@
+#include "request_parser.hpp"
+#include "log.hpp"
+#include "request.hpp"
+
+namespace http {
+
+ParseResult RequestParser::parse(std::span<char> data, Request& request) {
+    LOG_TRACE("http::RequestParser::parse()");
+
+    const char* bytes = data.data();
+    const size_t size = data.size();
+    size_t i = self.position;
+
+    while (i < size) {
+        if ((self.state < State::Body && i >= MAX_HEADER_SIZE) ||
+            self.framing_too_large(i)) {
+            return self.error(ParseError::HeaderTooLarge);
+        }
+
+        char c = bytes[i];
+
+        switch (self.state) {
+            case State::RequestLineStart: {
+                // 요청 앞의 빈 줄은 무시한다 (RFC 9112 2.2)
+                if (c == '\r' || c == '\n') {
+                    ++i;
+                    break;
+                }
+                if (!detail::is_token(c)) {
+                    return self.error(ParseError::InvalidMethod);
+                }
+                self.method_start = i;
+                self.state = State::Method;
+                ++i;
+                break;
+            }
+            case State::Method: {
+                while (i < size && detail::is_token(bytes[i])) {
+                    ++i;
+                }
+                if (i == size) {
+                    break;
+                }
+                if (bytes[i] != ' ') {
+                    return self.error(ParseError::InvalidMethod);
+                }
+                self.method_end = i;
+                self.target_start = ++i;
+                self.state = State::Target;
+                break;
+            }
+            case State::Target: {
+                i += SCAN_KERNELS.find_delimiter(bytes + i, size - i);
+                if (i == size) {
+                    break;
+                }
+                if (bytes[i] != ' ' || i == self.target_start) {
+                    return self.error(ParseError::InvalidTarget);
+                }
+                self.target_end = i;
+                self.version_start = ++i;
+                self.state = State::Version;
+                break;
+            }
+            case State::Version: {
+                i += SCAN_KERNELS.find_control(bytes + i, size - i);
+                if (i == size) {
+                    break;
+                }
+
+                std::string_view version(
+                    bytes + self.version_start, i - self.version_start);
+                if (version.size() != 8 || !version.starts_with("HTTP/") ||
+                    version[6] != '.') {
+                    return self.error(ParseError::InvalidVersion);
+                }
+                if (parse_http_version(version) == HttpVersion::Unknown) {
+                    return self.error(ParseError::UnsupportedVersion);
+                }
+                if (bytes[i] != '\r') {
+                    return self.error(ParseError::InvalidLineEnding);
+                }
+                self.state = State::RequestLineLf;
+                ++i;
+                break;
+            }
+            case State::RequestLineLf: {
+                if (c != '\n') {
+                    return self.error(ParseError::InvalidLineEnding);
+                }
+                self.state = State::HeaderLineStart;
+                ++i;
+                break;
+            }
+            case State::HeaderLineStart: {
+                if (c == '\r') {
+                    self.state = State::HeadersEndLf;
+                    ++i;
+                    break;
+                }
+                // obs-fold 와 공백으로 시작하는 필드 이름은 거부한다
+                if (!detail::is_token(c)) {
+                    return self.error(ParseError::InvalidHeaderName);
+                }
+                if (self.headers.size() == MAX_HEADER_COUNT) {
+                    return self.error(ParseError::TooManyHeaders);
+                }
+                self.token_start = i;
+                self.state = State::HeaderName;
+                ++i;
+                break;
+            }
+            case State::HeaderName: {
+                i += SCAN_KERNELS.find_field_name_end(bytes + i, size - i);
+                if (i == size) {
+                    break;
+                }
+                // 이름은 짧으므로 ':' 를 찾은 뒤 tchar 인지 한 번에 확인한다
+                if (bytes[i] != ':' ||
+                    !std::all_of(bytes + self.token_start, bytes + i,
+                        detail::is_token)) {
+                    return self.error(ParseError::InvalidHeaderName);
+                }
+                self.headers.push_back(HeaderOffsets{
+                    classify_field(std::string_view(
+                        bytes + self.token_start, i - self.token_start)),
+                    static_cast<uint32_t>(self.token_start),
+                    static_cast<uint32_t>(i - self.token_start), 0, 0});
+                self.state = State::HeaderValueStart;
+                ++i;
+                break;
+            }
+            case State::HeaderValueStart: {
+                while (i < size && (bytes[i] == ' ' || bytes[i] == '\t')) {
+                    ++i;
+                }
+                if (i == size) {
+                    break;
+                }
+                self.token_start = i;
+                self.state = State::HeaderValue;
+                break;
+            }
+            case State::HeaderValue: {
+                // HTAB 을 제외한 제어 문자에서 멈춘다
+                i += SCAN_KERNELS.find_control(bytes + i, size - i);
+                if (i < size && bytes[i] == '\t') {
+                    ++i;
+                    break;
+                }
+                if (i == size) {
+                    break;
+                }
+                if (bytes[i] != '\r') {
+                    return self.error(ParseError::InvalidHeaderValue);
+                }
+
+                size_t value_end = i;
+                while (value_end > self.token_start &&
+                       (bytes[value_end - 1] == ' ' ||
+                           bytes[value_end - 1] == '\t')) {
+                    --value_end;
+                }
+
+                HeaderOffsets& header = self.headers.back();
+                header.value_start = static_cast<uint32_t>(self.token_start);
+                header.value_length =
+                    static_cast<uint32_t>(value_end - self.token_start);
+
+                ParseError header_error =
+                    self.on_header(std::string_view(bytes, size));
+                if (header_error != ParseError::None) {
+                    return self.error(header_error);
+                }
+
+                self.state = State::HeaderValueLf;
+                ++i;
+                break;
+            }
+            case State::HeaderValueLf: {
+                if (c != '\n') {
+                    return self.error(ParseError::InvalidLineEnding);
+                }
+                self.state = State::HeaderLineStart;
+                ++i;
+                break;
+            }
+            case State::HeadersEndLf: {
+                if (c != '\n') {
+                    return self.error(ParseError::InvalidLineEnding);
+                }
+                ++i;
+                self.body_start = i;
+                self.body_end = i;
+
+                if (self.chunked) {
+                    self.state = State::ChunkSize;
+                    self.chunk_remaining = 0;
+                    self.chunk_size_digits = 0;
+                    break;
+                }
+
+                if (self.content_length == 0) {
+                    self.position = i;
+                    return self.complete(data, request);
+                }
+
+                self.state = State::Body;
+                break;
+            }
+            case State::Body: {
+                size_t end = self.body_start + self.content_length;
+                if (size < end) {
+                    i = size;
+                    break;
+                }
+                self.body_end = end;
+                self.position = end;
+                return self.complete(data, request);
+            }
+            case State::ChunkSize: {
+                int32_t digit = detail::hex_value(c);
+                if (digit >= 0) {
+                    // 앞의 0 은 크기를 키우지 않으므로 자릿수로 제한한다
+                    if (self.chunk_size_digits == MAX_CHUNK_SIZE_DIGITS) {
+                        return self.error(ParseError::InvalidChunk);
+                    }
+                    if (self.chunk_remaining > (MAX_BODY_SIZE >> 4)) {
+                        return self.error(ParseError::BodyTooLarge);
+                    }
+                    self.chunk_remaining = (self.chunk_remaining << 4) |
+                                           static_cast<size_t>(digit);
+                    ++self.chunk_size_digits;
+                    ++i;
+                    break;
+                }
+                if (self.chunk_size_digits == 0) {
+                    return self.error(ParseError::InvalidChunk);
+                }
+                if (c == ';' || c == ' ' || c == '\t') {
+                    self.state = State::ChunkExtension;
+                } else if (c == '\r') {
+                    self.state = State::ChunkSizeLf;
+                } else {
+                    return self.error(ParseError::InvalidChunk);
+                }
+                ++i;
+                break;
+            }
+            case State::ChunkExtension: {
+                i += SCAN_KERNELS.find_control(bytes + i, size - i);
+                if (i < size && bytes[i] != '\r') {
+                    ++i;
+                    break;
+                }
+                if (i == size) {
+                    break;
+                }
+                self.state = State::ChunkSizeLf;
+                ++i;
+                break;
+            }
+            case State::ChunkSizeLf: {
+                if (c != '\n') {
+                    return self.error(ParseError::InvalidChunk);
+                }
+                ++i;
+
+                if (self.chunk_remaining == 0) {
+                    self.state = State::TrailerLineStart;
+                    break;
+                }
+                if (self.body_end - self.body_start + self.chunk_remaining >
+                    MAX_BODY_SIZE) {
+                    return self.error(ParseError::BodyTooLarge);
+                }
+                self.state = State::ChunkData;
+                break;
+            }
+            case State::ChunkData: {
+                // 청크 데이터를 본문 끝으로 당겨 연속된 본문을 만든다
+                size_t available = std::min(size - i, self.chunk_remaining);
+                if (self.body_end != i) {
+                    std::memmove(data.data() + self.body_end, bytes + i,
+                        available);
+                }
+                self.body_end += available;
+                self.chunk_remaining -= available;
+                i += available;
+
+                if (self.chunk_remaining == 0) {
+                    self.state = State::ChunkDataCr;
+                }
+                break;
+            }
+            case State::ChunkDataCr: {
+                if (c != '\r') {
+                    return self.error(ParseError::InvalidChunk);
+                }
+                self.state = State::ChunkDataLf;
+                ++i;
+                break;
+            }
+            case State::ChunkDataLf: {
+                if (c != '\n') {
+                    return self.error(ParseError::InvalidChunk);
+                }
+                self.state = State::ChunkSize;
+                self.chunk_size_digits = 0;
+                ++i;
+                break;
+            }
+            case State::TrailerLineStart: {
+                if (c == '\r') {
+                    self.state = State::TrailerEndLf;
+                    ++i;
+                    break;
+                }
+                if (self.trailer_count == MAX_HEADER_COUNT) {
+                    return self.error(ParseError::TooManyHeaders);
+                }
+                ++self.trailer_count;
+                self.state = State::TrailerLine;
+                ++i;
+                break;
+            }
+            case State::TrailerLine: {
+                i += SCAN_KERNELS.find_control(bytes + i, size - i);
+                if (i < size && bytes[i] != '\r') {
+                    ++i;
+                    break;
+                }
+                if (i == size) {
+                    break;
+                }
+                self.state = State::TrailerLineLf;
+                ++i;
+                break;
+            }
+            case State::TrailerLineLf: {
+                if (c != '\n') {
+                    return self.error(ParseError::InvalidLineEnding);
+                }
+                self.state = State::TrailerLineStart;
+                ++i;
+                break;
+            }
+            case State::TrailerEndLf: {
+                if (c != '\n') {
+                    return self.error(ParseError::InvalidLineEnding);
+                }
+                self.position = i + 1;
+                return self.complete(data, request);
+            }
+        }
+    }
+
+    if ((self.state < State::Body && i >= MAX_HEADER_SIZE) ||
+        self.framing_too_large(i)) {
+        return self.error(ParseError::HeaderTooLarge);
+    }
+
+    self.position = i;
+    return ParseResult{ParseStatus::Incomplete};
+}
+
+ParseError RequestParser::on_header(std::string_view data) noexcept {
+    const HeaderOffsets& header = self.headers.back();
+    std::string_view value =
+        data.substr(header.value_start, header.value_length);
+
+    if (header.id == FieldId::ContentLength) {
+        size_t length = 0;
+        auto [end, error] =
+            std::from_chars(value.data(), value.data() + value.size(), length);
+
+        if (value.empty() || error != std::errc{} ||
+            end != value.data() + value.size() ||
+            (self.has_content_length && length != self.content_length)) {
+            return ParseError::InvalidContentLength;
+        }
+        if (length > MAX_BODY_SIZE) {
+            return ParseError::BodyTooLarge;
+        }
+        if (self.chunked) {
+            return ParseError::ConflictingLength;
+        }
+
+        self.has_content_length = true;
+        self.content_length = length;
+    } else if (header.id == FieldId::TransferEncoding) {
+        // 지원하는 전송 코딩은 chunked 하나뿐이다
+        if (!iequals(value, "chunked")) {
+            return ParseError::UnsupportedTransferEncoding;
+        }
+        if (self.has_content_length) {
+            return ParseError::ConflictingLength;
+        }
+        self.chunked = true;
+    }
+
+    return ParseError::None;
+}
+
+ParseResult RequestParser::complete(std::span<char> data, Request& request) {
+    std::string_view bytes(data.data(), data.size());
+
+    request.method = parse_method(
+        bytes.substr(self.method_start, self.method_end - self.method_start));
+    request.request_target =
+        bytes.substr(self.target_start, self.target_end - self.target_start);
+
+    size_t query = request.request_target.find('?');
+    request.route = request.request_target.substr(0, query);
+    request.query = query == std::string_view::npos
+                        ? std::string_view{}
+                        : request.request_target.substr(query + 1);
+    request.http_version =
+        parse_http_version(bytes.substr(self.version_start, 8));
+
+    request.fields.clear();
+    for (const HeaderOffsets& header : self.headers) {
+        request.fields.add(header.id,
+            bytes.substr(header.name_start, header.name_length),
+            bytes.substr(header.value_start, header.value_length));
+    }
+
+    request.body =
+        bytes.substr(self.body_start, self.body_end - self.body_start);
+
+    size_t consumed = self.position;
+    self.reset();
+    return ParseResult{ParseStatus::Complete, consumed};
+}
+
+}  // namespace http
@@ -0,0 +1,254 @@
+#pragma once
+
+#include <algorithm>
+#include <array>
+#include <charconv>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <span>
+#include <string_view>
+#include <vector>
+#include "header_fields.hpp"
+#include "http_code.hpp"
+#include "http_method.hpp"
+#include "http_version.hpp"
+#include "log.hpp"
+#include "simd_scan.hpp"
+#include "string_utils.hpp"
+
+namespace http {
+
+static constexpr size_t MAX_HEADER_SIZE = 64 * 1024;
+static constexpr size_t MAX_HEADER_COUNT = 100;
+static constexpr size_t MAX_BODY_SIZE = 16 * 1024 * 1024;
+static constexpr size_t MAX_CHUNK_SIZE_DIGITS = 16;
+
+struct Request;
+
+enum struct ParseStatus { Complete, Incomplete, Error };
+
+enum struct ParseError {
+    None,
+    InvalidMethod,
+    InvalidTarget,
+    InvalidVersion,
+    UnsupportedVersion,
+    InvalidRequestLine,
+    InvalidHeaderName,
+    InvalidHeaderValue,
+    InvalidLineEnding,
+    HeaderTooLarge,
+    TooManyHeaders,
+    InvalidContentLength,
+    ConflictingLength,
+    UnsupportedTransferEncoding,
+    InvalidChunk,
+    BodyTooLarge,
+};
+
+struct ParseResult {
+    ParseStatus status;
+    size_t consumed = 0;  // Complete 일 때 요청 전체 길이
+    ParseError error = ParseError::None;
+};
+
+std::string_view parse_error_to_string(ParseError error) {
+    LOG_TRACE("http::parse_error_to_string()");
+    using namespace std::string_view_literals;
+    switch (error) {
+        case ParseError::None:
+            return "no error"sv;
+        case ParseError::InvalidMethod:
+            return "invalid method"sv;
+        case ParseError::InvalidTarget:
+            return "invalid request target"sv;
+        case ParseError::InvalidVersion:
+            return "invalid http version"sv;
+        case ParseError::UnsupportedVersion:
+            return "unsupported http version"sv;
+        case ParseError::InvalidRequestLine:
+            return "invalid request line"sv;
+        case ParseError::InvalidHeaderName:
+            return "invalid header name"sv;
+        case ParseError::InvalidHeaderValue:
+            return "invalid header value"sv;
+        case ParseError::InvalidLineEnding:
+            return "expected CRLF"sv;
+        case ParseError::HeaderTooLarge:
+            return "header section too large"sv;
+        case ParseError::TooManyHeaders:
+            return "too many header fields"sv;
+        case ParseError::InvalidContentLength:
+            return "invalid Content-Length"sv;
+        case ParseError::ConflictingLength:
+            return "both Content-Length and Transfer-Encoding present"sv;
+        case ParseError::UnsupportedTransferEncoding:
+            return "unsupported Transfer-Encoding"sv;
+        case ParseError::InvalidChunk:
+            return "invalid chunk"sv;
+        case ParseError::BodyTooLarge:
+            return "body too large"sv;
+        default:
+            std::unreachable();
+    }
+}
+
+HttpCode parse_error_to_http_code(ParseError error) {
+    LOG_TRACE("http::parse_error_to_http_code()");
+    switch (error) {
+        case ParseError::UnsupportedVersion:
+            return HttpCode::HTTPVersionNotSupported;
+        case ParseError::HeaderTooLarge:
+        case ParseError::TooManyHeaders:
+            return HttpCode::RequestHeaderFieldsTooLarge;
+        case ParseError::UnsupportedTransferEncoding:
+            return HttpCode::NotImplemented;
+        case ParseError::BodyTooLarge:
+            return HttpCode::ContentTooLarge;
+        case ParseError::InvalidTarget:
+            return HttpCode::BadRequest;
+        default:
+            return HttpCode::BadRequest;
+    }
+}
+
+namespace detail {
+
+// RFC 9110 tchar
+constexpr std::array<bool, 256> make_token_table() {
+    std::array<bool, 256> table{};
+    for (int c = '0'; c <= '9'; ++c) table[c] = true;
+    for (int c = 'a'; c <= 'z'; ++c) table[c] = true;
+    for (int c = 'A'; c <= 'Z'; ++c) table[c] = true;
+    for (char c : std::string_view("!#$%&'*+-.^_`|~")) {
+        table[static_cast<unsigned char>(c)] = true;
+    }
+    return table;
+}
+
+constexpr std::array<bool, 256> TOKEN_TABLE = make_token_table();
+
+constexpr bool is_token(char c) noexcept {
+    return TOKEN_TABLE[static_cast<unsigned char>(c)];
+}
+
+constexpr int32_t hex_value(char c) noexcept {
+    if (c >= '0' && c <= '9') return c - '0';
+    if (c >= 'a' && c <= 'f') return c - 'a' + 10;
+    if (c >= 'A' && c <= 'F') return c - 'A' + 10;
+    return -1;
+}
+
+}  // namespace detail
+
+/**
+ * Resumable single-pass HTTP/1.1 request parser.
+ *
+ * `parse()` is given every byte received so far for the current request,
+ * starting at the request line, and continues from where the previous call
+ * stopped. Positions are kept as offsets, so the caller may move the bytes
+ * between calls. Chunked bodies are decoded in place, which is why the input
+ * is mutable. On `Complete` the `Request` holds views into `data`.
+ */
+class RequestParser {
+public:
+    ParseResult parse(std::span<char> data, Request& request);
+
+    // 헤더를 모두 읽고 본문을 기다리는 중인지
+    bool in_body() const noexcept {
+        return self.state >= State::Body;
+    }
+
+    void reset() noexcept {
+        self.state = State::RequestLineStart;
+        self.position = 0;
+        self.token_start = 0;
+        self.method_start = 0;
+        self.method_end = 0;
+        self.target_start = 0;
+        self.target_end = 0;
+        self.version_start = 0;
+        self.headers.clear();
+        self.content_length = 0;
+        self.has_content_length = false;
+        self.chunked = false;
+        self.body_start = 0;
+        self.body_end = 0;
+        self.chunk_remaining = 0;
+        self.chunk_size_digits = 0;
+        self.trailer_count = 0;
+    }
+
+private:
+    enum struct State {
+        RequestLineStart,
+        Method,
+        Target,
+        Version,
+        RequestLineLf,
+        HeaderLineStart,
+        HeaderName,
+        HeaderValueStart,
+        HeaderValue,
+        HeaderValueLf,
+        HeadersEndLf,
+        Body,
+        ChunkSize,
+        ChunkExtension,
+        ChunkSizeLf,
+        ChunkData,
+        ChunkDataCr,
+        ChunkDataLf,
+        TrailerLineStart,
+        TrailerLine,
+        TrailerLineLf,
+        TrailerEndLf,
+    };
+
+    struct HeaderOffsets {
+        FieldId id;
+        uint32_t name_start;
+        uint32_t name_length;
+        uint32_t value_start;
+        uint32_t value_length;
+    };
+
+    ParseResult error(ParseError error) noexcept {
+        self.reset();
+        return ParseResult{ParseStatus::Error, 0, error};
+    }
+
+    // 청크 크기 줄, 확장, 트레일러처럼 본문이 아닌 바이트도 헤더만큼 제한한다
+    bool framing_too_large(size_t i) const noexcept {
+        return self.state > State::Body &&
+               i - self.body_end >= MAX_HEADER_SIZE;
+    }
+
+    ParseError on_header(std::string_view data) noexcept;
+    ParseResult complete(std::span<char> data, Request& request);
+
+private:
+    RequestParser& self = *this;
+
+    State state = State::RequestLineStart;
+    size_t position = 0;
+    size_t token_start = 0;
+    size_t method_start = 0;
+    size_t method_end = 0;
+    size_t target_start = 0;
+    size_t target_end = 0;
+    size_t version_start = 0;
+    std::vector<HeaderOffsets> headers;
+
+    size_t content_length = 0;
+    bool has_content_length = false;
+    bool chunked = false;
+    size_t body_start = 0;
+    size_t body_end = 0;  // 디코딩된 chunked 본문의 끝
+    size_t chunk_remaining = 0;
+    size_t chunk_size_digits = 0;
+    size_t trailer_count = 0;
+};
+
+}  // namespace http
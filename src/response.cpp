@@ -1,4 +1,8 @@
 #include "response.hpp"
+#include <array>
+#include <cstring>
+#include <format>
+#include "hash.hpp"
 #include "log.hpp"
 #include "request.hpp"
 #include "server.hpp"
@@ -6,6 +10,35 @@
 
 namespace http {
 
+namespace {
+
+static constexpr size_t BODY_HASH_CACHE_SLOTS = 256;
+
+// 공유된 본문의 해시, 본문 주소로 찾는 direct-mapped 표의 한 칸
+struct BodyHashSlot {
+    const char* data = nullptr;
+    size_t size = 0;
+    std::weak_ptr<const void> owner;
+    uint64_t hash = 0;
+};
+
+// 주소가 재사용될 수 있으므로 주인은 제어 블록으로 비교한다
+bool same_owner(const std::weak_ptr<const void>& cached,
+    const std::shared_ptr<const void>& owner) noexcept {
+    return !cached.expired() && !cached.owner_before(owner) &&
+           !owner.owner_before(cached);
+}
+
+// 호스트와 경로를 아레나의 필드 값에 바로 이어 붙인다
+void add_location(
+    Response& response, const Server& server, const Request& request) {
+    std::pmr::string& location = response.fields["Location"];
+    location.reserve(server.get_host().size() + request.route.size());
+    location.append(server.get_host()).append(request.route);
+}
+
+}  // namespace
+
 Response Response::create(const Server& server, const Request& request,
     HttpCode http_code, ContentType content_type, std::string_view body) {
     LOG_TRACE("http::Response::create()");
@@ -16,48 +49,242 @@ Response Response::create(const Server& server, const Request& request,
     response.body = body;
 
     // Fields
+    // 종류와 관계없이 길이를 알려야 연결을 유지할 수 있다
+    add_location(response, server, request);
+    response.fields.insert({"Content-Type", get_content_type(content_type)});
     response.fields.insert(
-        {"Location", std::format("{}{}", server.get_host(), request.route)});
+        {"Content-Length", LengthText{}.format(body.size())});
+
+    return response;
+}
+
+Response Response::create_file(const Server& server, const Request& request,
+    HttpCode http_code, ContentType content_type, FileBody file) {
+    LOG_TRACE("http::Response::create_file()");
+    Response response{};
+
+    response.http_version = request.http_version;
+    response.http_code = http_code;
+
+    // 파일은 종류와 관계없이 길이를 알고 있다
+    add_location(response, server, request);
+    response.fields.insert({"Content-Type", get_content_type(content_type)});
     response.fields.insert(
-        {"Content-Type", std::string(get_content_type(content_type))});
-    ContentTypeCategory category = get_content_type_category(content_type);
-    switch (category) {
-        case ContentTypeCategory::Text: {
-            response.fields.insert(
-                {"Content-Length", std::to_string(body.size())});
-            break;
+        {"Content-Length", LengthText{}.format(file.length)});
+    response.fields.insert({"Accept-Ranges", "bytes"});
+
+    response.file = std::move(file);
+    return response;
+}
+
+namespace {
+
+// 새 본문을 넣기 전에 이전 본문을 모두 비우고 길이를 맞춘다
+void replace_body(Response& response, std::optional<uint64_t> length) {
+    response.body = {};
+    response.body_owner.reset();
+    response.file.reset();
+    response.parts.clear();
+    response.stream.reset();
+    if (length.has_value()) {
+        response.fields["Content-Length"] =
+            LengthText{}.format(length.value());
+    } else {
+        response.fields.erase("Content-Length");
+    }
+}
+
+}  // namespace
+
+void Response::set_body(std::string owned) {
+    set_body(std::make_shared<const std::string>(std::move(owned)));
+}
+
+void Response::set_body(std::shared_ptr<const std::string> shared) {
+    std::string_view bytes = *shared;
+    replace_body(*this, bytes.size());
+    body = bytes;
+    body_owner = std::move(shared);
+}
+
+void Response::set_body(std::shared_ptr<const MappedFile> mapped) {
+    std::string_view bytes = mapped->bytes();
+    replace_body(*this, bytes.size());
+    body = bytes;
+    body_owner = std::move(mapped);
+}
+
+void Response::set_body(FileBody range) {
+    replace_body(*this, range.length);
+    file = std::move(range);
+}
+
+void Response::set_body(BodyStream generator) {
+    replace_body(*this, generator.length);
+    stream = std::move(generator);
+}
+
+uint64_t BodyHash::get() noexcept {
+    if (self.hash.has_value()) {
+        return self.hash.value();
+    }
+
+    std::string_view body = self.response.body;
+    const std::shared_ptr<const void>& owner = self.response.body_owner;
+
+    // 이 응답만 가진 본문은 다시 보내지지 않으므로 기억하지 않는다
+    if (owner == nullptr || owner.use_count() < 2) {
+        self.hash = hash_bytes(body);
+        return self.hash.value();
+    }
+
+    thread_local std::array<BodyHashSlot, BODY_HASH_CACHE_SLOTS> slots;
+    size_t index = ((reinterpret_cast<uintptr_t>(body.data()) >> 4) ^
+                       body.size()) %
+                   BODY_HASH_CACHE_SLOTS;
+    BodyHashSlot& slot = slots[index];
+
+    if (slot.data != body.data() || slot.size != body.size() ||
+        !same_owner(slot.owner, owner)) {
+        slot = BodyHashSlot{body.data(), body.size(), owner, hash_bytes(body)};
+    }
+    self.hash = slot.hash;
+    return slot.hash;
+}
+
+uint64_t Response::body_size(const Response& response) noexcept {
+    if (!response.parts.empty()) {
+        uint64_t size = 0;
+        for (const BodyPart& part : response.parts) {
+            size += part.head.size() + part.length;
         }
-        case ContentTypeCategory::Application: {
-            if (content_type == ContentType::JSON) {
-                response.fields.insert(
-                    {"Content-Length", std::to_string(body.size())});
-            }
-            break;
+        return size;
+    }
+    if (response.file.has_value()) {
+        return response.file->length;
+    }
+    if (response.stream.has_value()) {
+        return response.stream->length.value_or(0);
+    }
+    return response.body.size();
+}
+
+namespace {
+
+// "HTTP/1.x 200 OK\r\n" 을 버전과 상태 코드별로 미리 만들어 둔다
+struct StatusLines {
+    std::array<std::string, 600> http1_0;
+    std::array<std::string, 600> http1_1;
+
+    StatusLines() {
+        for (HttpCode http_code : HTTP_CODES) {
+            size_t index = static_cast<size_t>(http_code);
+            std::string_view reason = http_code_to_string(http_code);
+            http1_0[index] = std::format("HTTP/1.0 {}\r\n", reason);
+            http1_1[index] = std::format("HTTP/1.1 {}\r\n", reason);
         }
-        default:
     }
+};
 
-    return response;
+const StatusLines STATUS_LINES{};
+
+char* write_bytes(char* out, std::string_view bytes) noexcept {
+    std::memcpy(out, bytes.data(), bytes.size());
+    return out + bytes.size();
 }
 
-std::string Response::response_to_message(const Response& response) noexcept {
-    LOG_TRACE("http::Response::get_full_message()");
-    std::vector<std::string> message;
+}  // namespace
+
+std::string_view Response::status_line(
+    HttpVersion http_version, HttpCode http_code) noexcept {
+    size_t index = static_cast<size_t>(http_code);
+    if (http_version == HttpVersion::Http1_0) {
+        return STATUS_LINES.http1_0[index];
+    }
+    return STATUS_LINES.http1_1[index];
+}
+
+size_t Response::head_size(const Response& response) noexcept {
+    size_t size =
+        Response::status_line(response.http_version, response.http_code)
+            .size();
+    for (const auto& [key, value] : response.fields) {
+        size += key.size() + value.size() + 4;  // ": " + CRLF
+    }
+    return size + 2;
+}
+
+char* Response::write_head(const Response& response, char* out) noexcept {
+    LOG_TRACE("http::Response::write_head()");
+    out = write_bytes(
+        out, Response::status_line(response.http_version, response.http_code));
 
-    // Status Line
-    message.push_back(
-        std::format("{} {}", http_version_to_string(response.http_version),
-            http_code_to_string(response.http_code)));
-    // Fields
     for (const auto& [key, value] : response.fields) {
-        message.push_back(std::format("{}: {}", key, value));
+        out = write_bytes(out, key);
+        out = write_bytes(out, ": ");
+        out = write_bytes(out, value);
+        out = write_bytes(out, "\r\n");
+    }
+
+    return write_bytes(out, "\r\n");
+}
+
+std::string Response::response_to_message(const Response& response) {
+    LOG_TRACE("http::Response::response_to_message()");
+    size_t head_size = Response::head_size(response);
+    size_t body_size = static_cast<size_t>(Response::body_size(response));
+
+    std::string message(head_size + body_size, '\0');
+    char* end = Response::write_head(response, message.data());
+
+    // 페이지 캐시에서 바로 보낼 수 없으면 파일 내용을 복사한다
+    auto write_span = [&response](char* out, uint64_t offset,
+                          size_t length) noexcept -> char* {
+        if (!response.file.has_value()) {
+            return write_bytes(out,
+                response.body.substr(static_cast<size_t>(offset), length));
+        }
+        const FileBody& file = response.file.value();
+        if (!file.file->read(file.offset + offset, length, out)) {
+            return nullptr;
+        }
+        return out + length;
+    };
+
+    // 스트림은 메시지를 다 채울 때까지 끌어온다
+    if (response.stream.has_value()) {
+        char* limit = end + body_size;
+        while (end != nullptr && end != limit) {
+            size_t written = response.stream->next(
+                std::span<char>(end, static_cast<size_t>(limit - end)));
+            end = written == 0 ? nullptr : end + written;
+        }
+    } else if (response.parts.empty()) {
+        end = write_span(end, 0, body_size);
+    }
+    for (const BodyPart& part : response.parts) {
+        end = write_bytes(end, part.head);
+        end = write_span(end, part.offset, static_cast<size_t>(part.length));
+        if (end == nullptr) {
+            break;
+        }
     }
 
-    // Body
-    message.push_back("");
-    message.push_back(std::string(response.body));
+    if (end == nullptr) {
+        LOG_ERROR("Failed to read file or stream body");
+        return Response::error_to_message(HttpCode::InternalServerError);
+    }
+    return message;
+}
+
+std::string Response::error_to_message(HttpCode http_code) noexcept {
+    LOG_TRACE("http::Response::error_to_message()");
 
-    return join(message, "\r\n");
+    // 파싱에 실패한 요청에는 본문 없이 응답하고 연결을 닫는다
+    std::string message(
+        Response::status_line(HttpVersion::Http1_1, http_code));
+    message += "Connection: close\r\nContent-Length: 0\r\n\r\n";
+    return message;
 }
 
 }  // namespace http
\ No newline at end of file
@@ -1,27 +1,132 @@
 #pragma once
+#include <array>
+#include <charconv>
+#include <cstddef>
+#include <functional>
+#include <memory>
+#include <optional>
+#include <span>
 #include <string>
 #include <string_view>
-#include <unordered_map>
+#include <vector>
 #include "content_type.hpp"
+#include "file.hpp"
 #include "http_code.hpp"
 #include "http_method.hpp"
 #include "http_version.hpp"
+#include "response_fields.hpp"
 
 namespace http {
 
 class Server;
 class Request;
 
+/**
+ * One part of a `multipart/byteranges` body: `head` is sent as is, then
+ * `length` bytes from `offset` into the response's body or file range.
+ */
+struct BodyPart {
+    std::string head;
+    uint64_t offset = 0;
+    uint64_t length = 0;
+};
+
+// 정수를 필드 값으로 쓸 때 힙 대신 쓰는 버퍼
+struct LengthText {
+    std::array<char, 20> buffer;
+
+    std::string_view format(uint64_t value) noexcept {
+        auto [end, error] =
+            std::to_chars(buffer.data(), buffer.data() + buffer.size(), value);
+        return std::string_view(buffer.data(), end);
+    }
+};
+
+/**
+ * Body produced while it is sent. `next` writes the next piece of the body
+ * into the buffer it is given and returns how many bytes it wrote. With a
+ * `length` the pieces add up to exactly that many bytes and ending early
+ * closes the connection, since the client was promised `length` bytes.
+ * Without one the body is sent with `Transfer-Encoding: chunked`, one chunk
+ * per piece, and `next` returns 0 once it is done.
+ */
+struct BodyStream {
+    std::function<size_t(std::span<char> out)> next;
+    std::optional<uint64_t> length;
+};
+
 struct Response {
     HttpVersion http_version;
     HttpCode http_code;
-    std::unordered_map<std::string, std::string> fields;
+    // 응답하는 요청의 아레나에 할당된다
+    ResponseFields fields;
+    // 복사하지 않고 그대로 송신하므로 응답이 다 보내질 때까지 살아 있어야 한다
     std::string_view body;
+    // 있으면 body 가 가리키는 메모리를 가지고 있어, 송신이 끝날 때까지 산다
+    std::shared_ptr<const void> body_owner;
+    // 있으면 body 대신 파일 구간을 보낸다 (Linux 에서는 sendfile)
+    std::optional<FileBody> file;
+    // 비어 있지 않으면 body 나 file 대신 부분들을 차례로 보낸다
+    std::vector<BodyPart> parts;
+    // 있으면 다른 본문 대신 보내면서 만든다
+    std::optional<BodyStream> stream;
+
+    /**
+     * Replaces the body and sets Content-Length to match, or leaves it out
+     * for a stream of unknown length. The response keeps an owned string
+     * alive itself and shares a shared buffer or mapping, so the body
+     * outlives the handler; each kind is sent without copying, a stream as it
+     * is produced.
+     */
+    void set_body(std::string owned);
+    void set_body(std::shared_ptr<const std::string> shared);
+    void set_body(std::shared_ptr<const MappedFile> mapped);
+    void set_body(FileBody range);
+    void set_body(BodyStream generator);
 
     static Response create(const Server& server, const Request& request,
         HttpCode http_code, ContentType content_type, std::string_view body);
+    static Response create_file(const Server& server, const Request& request,
+        HttpCode http_code, ContentType content_type, FileBody file);
+
+    // 실제로 보낼 본문의 길이, 길이를 모르는 스트림은 0
+    static uint64_t body_size(const Response& response) noexcept;
+
+    /**
+     * Status line and header fields, without the body, serialized in one
+     * pass. `write_head()` needs `head_size()` bytes at `out` and returns the
+     * end of what it wrote.
+     */
+    static size_t head_size(const Response& response) noexcept;
+    static char* write_head(const Response& response, char* out) noexcept;
+    static std::string_view status_line(
+        HttpVersion http_version, HttpCode http_code) noexcept;
+
+    // 스트림 본문이 던진 예외는 그대로 전해진다
+    static std::string response_to_message(const Response& response);
+    static std::string error_to_message(HttpCode http_code) noexcept;
+};
+
+/**
+ * XXH64 of a response's in-memory body, computed on first use so the ETag
+ * and the compression cache key share one pass. Shared bodies are also
+ * remembered per thread, so a buffer sent again is not hashed again.
+ */
+class BodyHash {
+public:
+    explicit BodyHash(const Response& response) noexcept
+        : response(response) {}
+
+    BodyHash(BodyHash&) = delete;
+    BodyHash& operator=(BodyHash&) = delete;
+
+    uint64_t get() noexcept;
+
+private:
+    BodyHash& self = *this;
 
-    static std::string response_to_message(const Response& response) noexcept;
+    const Response& response;
+    std::optional<uint64_t> hash;
 };
 
 }  // namespace http
\ No newline at end of file
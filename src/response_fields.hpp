@@ -0,0 +1,117 @@
+#pragma once
+
+#include <cstddef>
+#include <memory_resource>
+#include <string>
+#include <string_view>
+#include <utility>
+#include <vector>
+#include "arena.hpp"
+
+namespace http {
+
+// 대부분의 응답 헤더가 한 번에 들어가도록 처음에 잡아 두는 수
+static constexpr size_t RESPONSE_FIELD_RESERVE = 8;
+
+/**
+ * Response header fields in the order they were added, with the lookups of a
+ * map keyed by exact name. Names and values are allocated from the memory
+ * resource current when the response was made, the arena of the request it
+ * answers, so building a response does not go through the global allocator.
+ */
+class ResponseFields {
+public:
+    using Field = std::pair<std::pmr::string, std::pmr::string>;
+    using iterator = std::pmr::vector<Field>::iterator;
+    using const_iterator = std::pmr::vector<Field>::const_iterator;
+
+    ResponseFields() : fields(Arena::current()) {}
+
+    /**
+     * Adds `field` unless a field of that name exists, like
+     * `std::unordered_map::insert`.
+     */
+    std::pair<iterator, bool> insert(
+        std::pair<std::string_view, std::string_view> field) {
+        iterator existing = find(field.first);
+        if (existing != fields.end()) {
+            return {existing, false};
+        }
+
+        reserve();
+        fields.emplace_back(field.first, field.second);
+        return {fields.end() - 1, true};
+    }
+
+    // 없으면 빈 값으로 추가한다
+    std::pmr::string& operator[](std::string_view name) {
+        return insert({name, std::string_view()}).first->second;
+    }
+
+    iterator find(std::string_view name) noexcept {
+        iterator field = fields.begin();
+        while (field != fields.end() && field->first != name) {
+            ++field;
+        }
+        return field;
+    }
+
+    const_iterator find(std::string_view name) const noexcept {
+        const_iterator field = fields.begin();
+        while (field != fields.end() && field->first != name) {
+            ++field;
+        }
+        return field;
+    }
+
+    bool contains(std::string_view name) const noexcept {
+        return find(name) != fields.end();
+    }
+
+    size_t erase(std::string_view name) {
+        iterator field = find(name);
+        if (field == fields.end()) {
+            return 0;
+        }
+        fields.erase(field);
+        return 1;
+    }
+
+    iterator begin() noexcept {
+        return fields.begin();
+    }
+
+    iterator end() noexcept {
+        return fields.end();
+    }
+
+    const_iterator begin() const noexcept {
+        return fields.begin();
+    }
+
+    const_iterator end() const noexcept {
+        return fields.end();
+    }
+
+    size_t size() const noexcept {
+        return fields.size();
+    }
+
+    bool empty() const noexcept {
+        return fields.empty();
+    }
+
+private:
+    // 아레나는 돌려받지 않으므로 여러 번 늘리지 않게 한 번에 잡는다
+    void reserve() {
+        if (fields.capacity() == 0) {
+            fields.reserve(RESPONSE_FIELD_RESERVE);
+        }
+    }
+
+private:
+    // Response 와 함께 복사되므로 self 참조를 두지 않는다
+    std::pmr::vector<Field> fields;
+};
+
+}  // namespace http
@@ -0,0 +1,253 @@
+#pragma once
+#include <algorithm>
+#include <array>
+#include <charconv>
+#include <cstddef>
+#include <functional>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <tuple>
+#include <type_traits>
+#include <utility>
+#include "http_method.hpp"
+#include "request.hpp"
+#include "response.hpp"
+
+namespace http {
+
+class Server;
+
+/**
+ * String literal usable as a template argument, so a route pattern can be
+ * taken apart at compile time.
+ */
+template <size_t N>
+struct FixedString {
+    char data[N]{};
+
+    constexpr FixedString(const char (&str)[N]) noexcept {
+        std::copy_n(str, N, data);
+    }
+
+    constexpr std::string_view view() const noexcept {
+        return std::string_view(data, N - 1);
+    }
+};
+
+namespace detail {
+
+struct PatternSegment {
+    std::string_view text;  // 파라미터면 ':' 을 뺀 이름
+    bool param = false;
+};
+
+consteval size_t count_segments(std::string_view pattern) {
+    return static_cast<size_t>(
+        std::count(pattern.begin(), pattern.end(), '/'));
+}
+
+/**
+ * Splits "/a/:b" into {"a", false}, {"b", true}. Fails to compile on a
+ * pattern that does not start with '/', has an empty segment in the middle
+ * or a parameter without a name.
+ */
+template <size_t Count>
+consteval std::array<PatternSegment, Count> split_pattern(
+    std::string_view pattern) {
+    if (pattern.empty() || pattern.front() != '/') {
+        throw "Route pattern must start with '/'";
+    }
+
+    std::array<PatternSegment, Count> segments{};
+    size_t begin = 1;
+    for (size_t i = 0; i < Count; ++i) {
+        size_t end = std::min(pattern.find('/', begin), pattern.size());
+        std::string_view text = pattern.substr(begin, end - begin);
+
+        if (text.empty() && i + 1 != Count) {
+            throw "Route pattern has an empty segment";
+        }
+        if (!text.empty() && text.front() == ':') {
+            if (text.size() == 1) {
+                throw "Route parameter needs a name";
+            }
+            segments[i] = PatternSegment{text.substr(1), true};
+        } else {
+            segments[i] = PatternSegment{text, false};
+        }
+        begin = end + 1;
+    }
+    return segments;
+}
+
+template <size_t Count>
+consteval size_t count_params(
+    const std::array<PatternSegment, Count>& segments) {
+    return static_cast<size_t>(
+        std::count_if(segments.begin(), segments.end(),
+            [](const PatternSegment& segment) { return segment.param; }));
+}
+
+// 첫 파라미터 앞까지의 정적 접두사, 빠르게 걸러내는 데 쓴다
+consteval std::string_view static_prefix(std::string_view pattern) {
+    size_t colon = pattern.find(':');
+    return colon == std::string_view::npos ? pattern
+                                           : pattern.substr(0, colon);
+}
+
+/**
+ * Parameter types of a route handler
+ * `Response(const Server&, Request&&, Args...)`, given as a function pointer
+ * or a lambda without captures.
+ */
+template <typename F>
+struct HandlerTraits : HandlerTraits<decltype(&F::operator())> {};
+
+template <typename R, typename... Args>
+struct HandlerTraits<R (*)(const Server&, Request&&, Args...)> {
+    using Params = std::tuple<std::remove_cvref_t<Args>...>;
+};
+
+template <typename R, typename C, typename... Args>
+struct HandlerTraits<R (C::*)(const Server&, Request&&, Args...) const> {
+    using Params = std::tuple<std::remove_cvref_t<Args>...>;
+};
+
+}  // namespace detail
+
+/**
+ * Converts a captured path segment to a typed handler parameter:
+ * `std::string_view`, `std::string` or an integer. A segment that does not
+ * convert makes the route not match.
+ */
+template <typename T>
+std::optional<T> parse_route_param(std::string_view text) noexcept {
+    if constexpr (std::is_same_v<T, std::string_view>) {
+        return text;
+    } else if constexpr (std::is_same_v<T, std::string>) {
+        return std::string(text);
+    } else {
+        static_assert(std::is_integral_v<T>,
+            "Route parameters must be string_view, string or an integer");
+        T value{};
+        auto [end, error] =
+            std::from_chars(text.data(), text.data() + text.size(), value);
+        if (error != std::errc{} || end != text.data() + text.size()) {
+            return std::nullopt;
+        }
+        return value;
+    }
+}
+
+/**
+ * One entry of a `RouteTable`: `Handler` answers `M` requests whose path
+ * matches `Pattern`, where `:name` captures one segment. The handler is
+ * called directly as `Handler(server, std::move(request), params...)`, each
+ * parameter converted to the type the handler declares for it. HEAD is
+ * answered by GET routes.
+ */
+template <Method M, FixedString Pattern, auto Handler>
+struct Route {
+    static constexpr std::string_view pattern = Pattern.view();
+    static constexpr size_t segment_count = detail::count_segments(pattern);
+    static constexpr std::array<detail::PatternSegment, segment_count>
+        segments = detail::split_pattern<segment_count>(pattern);
+    static constexpr size_t param_count = detail::count_params(segments);
+    static constexpr std::string_view prefix = detail::static_prefix(pattern);
+
+    using Params = typename detail::HandlerTraits<decltype(Handler)>::Params;
+    static_assert(std::tuple_size_v<Params> == param_count,
+        "Route handler must take one parameter per :name in its pattern");
+
+    static bool try_invoke(const Server& server, Request& request,
+        std::optional<Response>& response) {
+        if (request.method != M &&
+            !(M == Method::Get && request.method == Method::Head)) {
+            return false;
+        }
+
+        std::string_view path = request.route;
+        if constexpr (param_count == 0) {
+            if (path != pattern) {
+                return false;
+            }
+            response = std::invoke(Handler, server, std::move(request));
+            return true;
+        } else {
+            if (!path.starts_with(prefix)) {
+                return false;
+            }
+
+            std::array<std::string_view, param_count> values{};
+            if (!Route::capture(path, values)) {
+                return false;
+            }
+            return Route::call(server, request, values, response,
+                std::make_index_sequence<param_count>{});
+        }
+    }
+
+private:
+    static bool capture(std::string_view path,
+        std::array<std::string_view, param_count>& values) noexcept {
+        size_t param = 0;
+        for (const detail::PatternSegment& segment : segments) {
+            if (path.empty() || path.front() != '/') {
+                return false;
+            }
+            path.remove_prefix(1);
+
+            size_t end = std::min(path.find('/'), path.size());
+            std::string_view text = path.substr(0, end);
+            if (segment.param) {
+                if (text.empty()) {
+                    return false;
+                }
+                values[param++] = text;
+            } else if (text != segment.text) {
+                return false;
+            }
+            path.remove_prefix(end);
+        }
+        return path.empty();
+    }
+
+    template <size_t... I>
+    static bool call(const Server& server, Request& request,
+        const std::array<std::string_view, param_count>& values,
+        std::optional<Response>& response,
+        std::index_sequence<I...>) {
+        std::tuple<std::optional<std::tuple_element_t<I, Params>>...> params{
+            parse_route_param<std::tuple_element_t<I, Params>>(values[I])...};
+        if (!(std::get<I>(params).has_value() && ...)) {
+            return false;
+        }
+
+        response = std::invoke(Handler, server, std::move(request),
+            std::move(*std::get<I>(params))...);
+        return true;
+    }
+};
+
+/**
+ * Fixed set of routes matched without any runtime structure: `dispatch()`
+ * tries each `Route` in declaration order, unrolled at compile time, and
+ * calls the first that matches. For small services whose routes are known
+ * when they are built; see `Router` for routes added at runtime.
+ */
+template <typename... Routes>
+struct RouteTable {
+    /**
+     * Answers `request` from the first matching route, or returns nullopt
+     * and leaves `request` untouched.
+     */
+    static std::optional<Response> dispatch(
+        const Server& server, Request& request) {
+        std::optional<Response> response = std::nullopt;
+        (Routes::try_invoke(server, request, response) || ...);
+        return response;
+    }
+};
+
+}  // namespace http
@@ -0,0 +1,233 @@
+#include "router.hpp"
+#include <format>
+#include <stdexcept>
+#include "log.hpp"
+
+namespace http {
+
+Router::Router() : root(std::make_unique<Node>()) {
+    LOG_TRACE("http::Router()");
+}
+
+Router::Router(Router&& other) noexcept
+    : root(std::move(other.root)), handlers(std::move(other.handlers)) {}
+
+Router& Router::operator=(Router&& other) noexcept {
+    self.root = std::move(other.root);
+    self.handlers = std::move(other.handlers);
+    return self;
+}
+
+void Router::add(
+    Method method, std::string_view pattern, RouteHandler handler) {
+    LOG_TRACE("http::Router::add()");
+
+    if (method == Method::Unknown) {
+        throw std::runtime_error(
+            std::format("Cannot route unknown method for {}", pattern));
+    }
+    if (pattern.empty() || pattern.front() != '/') {
+        throw std::runtime_error(
+            std::format("Route must start with '/': {}", pattern));
+    }
+
+    Node* node = self.root.get();
+    size_t param_count = 0;
+    size_t i = 0;
+    while (i < pattern.size()) {
+        char c = pattern[i];
+
+        if (c != ':' && c != '*') {
+            size_t end = pattern.find_first_of(":*", i);
+            if (end == std::string_view::npos) {
+                end = pattern.size();
+            }
+            node = Router::insert_static(node, pattern.substr(i, end - i));
+            i = end;
+            continue;
+        }
+
+        // 파라미터는 한 조각 전체를 차지해야 한다
+        if (pattern[i - 1] != '/') {
+            throw std::runtime_error(std::format(
+                "Route parameter must start a segment: {}", pattern));
+        }
+        if (++param_count > MAX_ROUTE_PARAMS) {
+            throw std::runtime_error(
+                std::format("Too many route parameters: {}", pattern));
+        }
+
+        size_t end = pattern.find('/', i);
+        if (end == std::string_view::npos) {
+            end = pattern.size();
+        }
+        std::string_view name = pattern.substr(i + 1, end - i - 1);
+
+        if (c == '*') {
+            if (end != pattern.size()) {
+                throw std::runtime_error(std::format(
+                    "Wildcard must be the last segment: {}", pattern));
+            }
+            node = Router::insert_param(node->wildcard, name, pattern);
+        } else {
+            node = Router::insert_param(node->param, name, pattern);
+        }
+        i = end;
+    }
+
+    int32_t& slot = node->handlers[static_cast<size_t>(method)];
+    if (slot != -1) {
+        throw std::runtime_error(std::format(
+            "Duplicate route: {} {}", method_to_string(method), pattern));
+    }
+    slot = static_cast<int32_t>(self.handlers.size());
+    self.handlers.push_back(std::move(handler));
+}
+
+Router::Node* Router::insert_static(Node* node, std::string_view text) {
+    while (!text.empty()) {
+        size_t index = node->indices.find(text.front());
+        if (index == std::string::npos) {
+            auto child = std::make_unique<Node>();
+            child->prefix = std::string(text);
+            node->indices.push_back(text.front());
+            node->children.push_back(std::move(child));
+            return node->children.back().get();
+        }
+
+        std::unique_ptr<Node>& child = node->children[index];
+        size_t common = 0;
+        size_t limit = std::min(child->prefix.size(), text.size());
+        while (common < limit && child->prefix[common] == text[common]) {
+            ++common;
+        }
+
+        // 공통 접두사에서 간선을 나눈다
+        if (common < child->prefix.size()) {
+            auto split = std::make_unique<Node>();
+            split->prefix = child->prefix.substr(0, common);
+            child->prefix.erase(0, common);
+            split->indices.push_back(child->prefix.front());
+            split->children.push_back(std::move(child));
+            child = std::move(split);
+        }
+
+        node = child.get();
+        text.remove_prefix(common);
+    }
+    return node;
+}
+
+Router::Node* Router::insert_param(std::unique_ptr<Node>& slot,
+    std::string_view name, std::string_view pattern) {
+    if (name.empty()) {
+        throw std::runtime_error(
+            std::format("Route parameter needs a name: {}", pattern));
+    }
+
+    if (slot == nullptr) {
+        slot = std::make_unique<Node>();
+        slot->name = std::string(name);
+    } else if (slot->name != name) {
+        throw std::runtime_error(
+            std::format("Route parameter :{} conflicts with :{} in {}", name,
+                slot->name, pattern));
+    }
+    return slot.get();
+}
+
+RouteMatch Router::match(Method method, std::string_view path) const noexcept {
+    LOG_TRACE("http::Router::match()");
+
+    RouteMatch result{};
+    if (method == Method::Unknown || path.empty()) {
+        return result;
+    }
+
+    RouteParams params{};
+    self.lookup(self.root.get(), path, static_cast<size_t>(method), params,
+        result);
+    return result;
+}
+
+bool Router::lookup(const Node* node, std::string_view rest, size_t method,
+    RouteParams& params, RouteMatch& result) const noexcept {
+    if (rest.empty()) {
+        if (self.accept(node, method, params, result)) {
+            return true;
+        }
+
+        // "/files/*path" 는 "/files/" 에도 맞는다
+        if (node->wildcard != nullptr) {
+            params.params[params.count++] =
+                RouteParam{node->wildcard->name, {}};
+            if (self.accept(node->wildcard.get(), method, params, result)) {
+                return true;
+            }
+            --params.count;
+        }
+        return false;
+    }
+
+    // 정적 조각, :name, *name 순서로 시도하고 실패하면 다음으로 넘어간다
+    size_t index = node->indices.find(rest.front());
+    if (index != std::string::npos) {
+        const Node* child = node->children[index].get();
+        if (rest.starts_with(child->prefix) &&
+            self.lookup(child, rest.substr(child->prefix.size()), method,
+                params, result)) {
+            return true;
+        }
+    }
+
+    if (node->param != nullptr) {
+        size_t end = std::min(rest.find('/'), rest.size());
+        if (end > 0) {
+            params.params[params.count++] =
+                RouteParam{node->param->name, rest.substr(0, end)};
+            if (self.lookup(node->param.get(), rest.substr(end), method,
+                    params, result)) {
+                return true;
+            }
+            --params.count;
+        }
+    }
+
+    if (node->wildcard != nullptr) {
+        params.params[params.count++] = RouteParam{node->wildcard->name, rest};
+        if (self.accept(node->wildcard.get(), method, params, result)) {
+            return true;
+        }
+        --params.count;
+    }
+
+    return false;
+}
+
+bool Router::accept(const Node* node, size_t method, const RouteParams& params,
+    RouteMatch& result) const noexcept {
+    int32_t index = node->handlers[method];
+
+    // HEAD 핸들러가 없으면 GET 핸들러로 답한다
+    if (index == -1 && method == static_cast<size_t>(Method::Head)) {
+        index = node->handlers[static_cast<size_t>(Method::Get)];
+    }
+
+    if (index != -1) {
+        result.status = RouteStatus::Found;
+        result.handler = &self.handlers[static_cast<size_t>(index)];
+        result.params = params;
+        return true;
+    }
+
+    // 경로는 맞지만 메서드가 다르면 405 를 위해 받는 메서드를 모은다
+    for (size_t other = 0; other < METHOD_COUNT; ++other) {
+        if (node->handlers[other] != -1) {
+            result.allowed |= uint32_t{1} << other;
+            result.status = RouteStatus::MethodNotAllowed;
+        }
+    }
+    return false;
+}
+
+}  // namespace http
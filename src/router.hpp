@@ -0,0 +1,144 @@
+#pragma once
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <optional>
+#include <span>
+#include <string>
+#include <string_view>
+#include <vector>
+#include "http_method.hpp"
+#include "request.hpp"
+#include "response.hpp"
+
+namespace http {
+
+static constexpr size_t MAX_ROUTE_PARAMS = 8;
+static constexpr size_t METHOD_COUNT = static_cast<size_t>(Method::Unknown);
+
+struct RouteParam {
+    std::string_view name;
+    std::string_view value;
+};
+
+/**
+ * Parameters captured from the request path, in the order they appear in the
+ * route. Values view the path as received, not percent-decoded, and are only
+ * valid while the request is.
+ */
+class RouteParams {
+public:
+    std::optional<std::string_view> find(std::string_view name) const noexcept {
+        for (const RouteParam& param : all()) {
+            if (param.name == name) {
+                return param.value;
+            }
+        }
+        return std::nullopt;
+    }
+
+    std::span<const RouteParam> all() const noexcept {
+        return std::span<const RouteParam>(params.data(), count);
+    }
+
+    size_t size() const noexcept {
+        return count;
+    }
+
+    bool empty() const noexcept {
+        return count == 0;
+    }
+
+private:
+    friend class Router;
+
+    // 복사해서 넘기므로 self 참조를 두지 않는다
+    std::array<RouteParam, MAX_ROUTE_PARAMS> params{};
+    size_t count = 0;
+};
+
+using RouteHandler = std::function<Response(Request&&, const RouteParams&)>;
+
+enum struct RouteStatus : uint8_t {
+    Found,
+    NotFound,
+    MethodNotAllowed,  // 경로는 있지만 이 메서드의 핸들러가 없다
+};
+
+struct RouteMatch {
+    RouteStatus status = RouteStatus::NotFound;
+    const RouteHandler* handler = nullptr;
+    RouteParams params;
+    // MethodNotAllowed 일 때 경로가 받는 메서드, Method 값 번째 비트
+    uint32_t allowed = 0;
+};
+
+/**
+ * Routes requests by method and path. Patterns are compiled into one
+ * compressed radix tree whose nodes hold a handler per method, so a lookup
+ * walks the path once whatever the number of routes.
+ *
+ * A pattern segment may be `:name`, which captures one segment, or, as the
+ * last segment, `*name`, which captures the rest of the path. Static text
+ * wins over `:name`, which wins over `*name`; a lookup only backs up where
+ * they share a position. HEAD falls back to the GET handler.
+ *
+ * Routes are added before the server starts; lookups never allocate.
+ */
+class Router {
+public:
+    Router();
+
+    Router(Router&) = delete;
+    Router& operator=(Router&) = delete;
+    Router(Router&& other) noexcept;
+    Router& operator=(Router&& other) noexcept;
+
+    /**
+     * Registers `handler` for `method` on `pattern`. Throws
+     * `std::runtime_error` for a malformed pattern, a parameter renamed at a
+     * position another route already uses, or a duplicate route.
+     */
+    void add(Method method, std::string_view pattern, RouteHandler handler);
+
+    RouteMatch match(Method method, std::string_view path) const noexcept;
+
+    bool empty() const noexcept {
+        return self.handlers.empty();
+    }
+
+private:
+    struct Node {
+        std::string prefix;   // 정적 노드가 차지하는 경로 조각
+        std::string name;     // :name, *name 노드의 파라미터 이름
+        std::string indices;  // 정적 자식마다 prefix 의 첫 글자
+        std::vector<std::unique_ptr<Node>> children;
+        std::unique_ptr<Node> param;
+        std::unique_ptr<Node> wildcard;
+        // Method 별 handlers 의 위치, 없으면 -1
+        std::array<int32_t, METHOD_COUNT> handlers;
+
+        Node() {
+            handlers.fill(-1);
+        }
+    };
+
+    static Node* insert_static(Node* node, std::string_view text);
+    static Node* insert_param(std::unique_ptr<Node>& slot,
+        std::string_view name, std::string_view pattern);
+
+    bool lookup(const Node* node, std::string_view rest, size_t method,
+        RouteParams& params, RouteMatch& result) const noexcept;
+    bool accept(const Node* node, size_t method, const RouteParams& params,
+        RouteMatch& result) const noexcept;
+
+private:
+    Router& self = *this;
+
+    std::unique_ptr<Node> root;
+    std::vector<RouteHandler> handlers;
+};
+
+}  // namespace http
@@ -1,4 +1,6 @@
 #include "server.hpp"
+#include "byte_range.hpp"
+#include "conditional.hpp"
 #include "log.hpp"
 #include "response.hpp"
 
@@ -6,38 +8,236 @@ namespace http {
 
 Server::Server() : socket(Socket()) {}
 Server::Server(ServerConfig server_config) : config(server_config) {
-    SocketConfig socket_config{
-        .port = server_config.port, .max_threads = server_config.max_threads};
+    SocketConfig socket_config{.port = server_config.port,
+        .max_threads = server_config.max_threads,
+        .engine = server_config.io_engine,
+        .reuse_port = server_config.reuse_port,
+        .pin_threads = server_config.pin_threads,
+        .thread_per_core = server_config.thread_per_core,
+        .max_connections = server_config.max_connections,
+        .idle_timeout = server_config.idle_timeout,
+        .header_timeout = server_config.header_timeout,
+        .body_timeout = server_config.body_timeout,
+        .max_requests_per_connection =
+            server_config.max_requests_per_connection};
     self.socket = Socket(socket_config);
+
+    if (!server_config.document_root.empty()) {
+        self.static_files = std::make_unique<StaticFiles>(
+            std::filesystem::path(server_config.document_root));
+    }
+    if (server_config.compression) {
+        self.compressor =
+            std::make_unique<Compressor>(server_config.compression_level,
+                server_config.compression_min_size,
+                server_config.compression_cache_size);
+    }
 }
-Server::Server(Server&& other) : socket(std::move(other.socket)) {}
+Server::Server(Server&& other)
+    : serving(std::move(other.serving)),
+      socket(std::move(other.socket)),
+      config(other.config),
+      static_files(std::move(other.static_files)),
+      compressor(std::move(other.compressor)),
+      route_table(other.route_table),
+      router(std::move(other.router)),
+      handler(std::move(other.handler)) {}
 Server& Server::operator=(Server&& other) {
+    self.serving = std::move(other.serving);
     self.socket = std::move(other.socket);
+    self.config = other.config;
+    self.static_files = std::move(other.static_files);
+    self.compressor = std::move(other.compressor);
+    self.route_table = other.route_table;
+    self.router = std::move(other.router);
+    self.handler = std::move(other.handler);
     return self;
 }
 
 void Server::listen() {
+    self.serve(self.handler);
+}
+
+void Server::on_receive(std::function<std::vector<Response>(Request&&)> func) {
+    self.handler = std::move(func);
+}
+
+void Server::route(
+    Method method, std::string_view pattern, RouteHandler handler) {
+    self.router.add(method, pattern, std::move(handler));
+}
+
+void Server::start(ReceiveHandler receive) {
+    self.socket.on_receive(receive);
     self.socket.init();
     self.socket.listen();
 }
 
-void Server::on_receive(std::function<std::vector<Response>(Request&&)> func) {
-    self.socket.on_receive([this, func](std::string_view raw_input)
-                               -> std::optional<std::vector<Response>> {
-        std::optional<Request> request = Request::create(raw_input);
-        if (!request.has_value()) {
-            LOG_ERROR("Invalid request: {}", raw_input);
-            return std::nullopt;
+Server::Exchange Server::begin(const Request& request) const {
+    // 값은 수신 버퍼를 가리키므로 요청을 넘긴 뒤에도 쓸 수 있다
+    Exchange exchange{};
+    exchange.target = request.request_target;
+    exchange.head = request.method == Method::Head;
+    exchange.conditional =
+        request.method == Method::Get || request.method == Method::Head;
+    if (std::optional<std::string_view> accept_encoding =
+            request.fields.find(FieldId::AcceptEncoding);
+        accept_encoding.has_value() && self.compressor != nullptr) {
+        exchange.encoding = negotiate_encoding(accept_encoding.value());
+    }
+    if (exchange.conditional) {
+        exchange.if_none_match = request.fields.find(FieldId::IfNoneMatch);
+        exchange.if_modified_since =
+            request.fields.find(FieldId::IfModifiedSince);
+    }
+    if (request.method == Method::Get) {
+        exchange.range = request.fields.find(FieldId::Range);
+        exchange.if_range = request.fields.find(FieldId::IfRange);
+    }
+
+    exchange.revalidating = exchange.if_none_match.has_value() ||
+                            exchange.if_modified_since.has_value();
+    exchange.cache_validators =
+        exchange.conditional && self.config.validator_cache_ttl.count() > 0;
+    exchange.now = std::chrono::steady_clock::now();
+    return exchange;
+}
+
+std::optional<Response> Server::respond_without_handler(
+    const Request& request, const Exchange& exchange) {
+    // 기억해 둔 검증자와 맞으면 핸들러를 부르지 않는다
+    if (exchange.cache_validators && exchange.revalidating) {
+        const ValidatorCache::Validators* cached =
+            ValidatorCache::local().find(
+                exchange.target, exchange.encoding, exchange.now);
+        if (cached != nullptr &&
+            is_not_modified(cached->etag, cached->last_modified,
+                exchange.if_none_match, exchange.if_modified_since)) {
+            Response response{};
+            response.http_version = request.http_version;
+            response.http_code = HttpCode::NotModified;
+            if (!cached->etag.empty()) {
+                response.fields.insert({"ETag", cached->etag});
+            }
+            if (!cached->last_modified.empty()) {
+                response.fields.insert(
+                    {"Last-Modified", cached->last_modified});
+            }
+            if (!cached->vary.empty()) {
+                response.fields.insert({"Vary", cached->vary});
+            }
+            return response;
+        }
+    }
+
+    if (self.static_files != nullptr) {
+        return self.static_files->serve(self, request);
+    }
+    return std::nullopt;
+}
+
+std::optional<Response> Server::dispatch_routes(
+    Request& request, bool has_handler) {
+    if (self.route_table != nullptr) {
+        std::optional<Response> response = self.route_table(self, request);
+        if (response.has_value()) {
+            return response;
         }
+    }
 
-        std::vector<Response> responses = func(std::move(request.value()));
+    if (self.router.empty()) {
+        return std::nullopt;
+    }
 
-        return std::optional(std::move(responses));
-    });
+    RouteMatch match = self.router.match(request.method, request.route);
+    if (match.status == RouteStatus::Found) {
+        return (*match.handler)(std::move(request), match.params);
+    }
+
+    // 라우터가 모르는 요청은 핸들러가 받는다
+    if (match.status != RouteStatus::MethodNotAllowed || has_handler) {
+        return std::nullopt;
+    }
+
+    Response response = Response::create(self, request,
+        HttpCode::MethodNotAllowed, ContentType::Text,
+        http_code_to_string(HttpCode::MethodNotAllowed));
+
+    // GET 을 받으면 HEAD 도 받는다
+    if ((match.allowed &
+            (uint32_t{1} << static_cast<size_t>(Method::Get))) != 0) {
+        match.allowed |= uint32_t{1} << static_cast<size_t>(Method::Head);
+    }
+    std::pmr::string& allow = response.fields["Allow"];
+    for (size_t method = 0; method < METHOD_COUNT; ++method) {
+        if ((match.allowed & (uint32_t{1} << method)) != 0) {
+            if (!allow.empty()) {
+                allow += ", ";
+            }
+            allow += method_to_string(static_cast<Method>(method));
+        }
+    }
+    return response;
+}
+
+Response Server::not_found(const Request& request) const {
+    return Response::create(self, request, HttpCode::NotFound,
+        ContentType::Text, http_code_to_string(HttpCode::NotFound));
+}
+
+void Server::finish(
+    Response& response, const Exchange& exchange, bool from_handler) {
+    if (response.http_code == HttpCode::Ok) {
+        self.finish_ok(response, exchange, from_handler);
+    }
+
+    // HEAD 에는 GET 과 같은 헤더만 보내고 본문은 보내지 않는다.
+    // 헤더가 GET 과 같도록 본문은 마지막에 뺀다
+    if (exchange.head) {
+        response.body = {};
+        response.body_owner.reset();
+        response.file.reset();
+        response.parts.clear();
+        response.stream.reset();
+    }
+}
+
+void Server::finish_ok(
+    Response& response, const Exchange& exchange, bool from_handler) {
+    BodyHash body_hash(response);
+    if (exchange.conditional) {
+        add_etag(response, body_hash);
+    }
+    if (self.compressor != nullptr) {
+        self.compressor->apply(response, exchange.encoding, body_hash);
+    }
+    if (!exchange.conditional) {
+        return;
+    }
+
+    // GET 이 기억해 둔 검증자는 HEAD 가 덮어쓰지 않는다
+    if (exchange.cache_validators && from_handler && !exchange.head) {
+        ValidatorCache::local().store(exchange.target, exchange.encoding,
+            response, exchange.now + self.config.validator_cache_ttl);
+    }
+
+    if (exchange.revalidating &&
+        is_not_modified(
+            response, exchange.if_none_match, exchange.if_modified_since)) {
+        make_not_modified(response);
+    } else if (exchange.range.has_value()) {
+        apply_byte_ranges(response, exchange.range.value(), exchange.if_range);
+    }
 }
 
 std::string_view Server::get_host() const noexcept {
     return self.config.host;
 }
 
+#ifndef _WIN32
+SocketStats Server::stats() const noexcept {
+    return self.socket.stats();
+}
+#endif
+
 }  // namespace http
\ No newline at end of file
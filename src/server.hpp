@@ -1,6 +1,14 @@
 #pragma once
+#include <chrono>
+#include <memory>
+#include <type_traits>
+#include "compression.hpp"
+#include "middleware.hpp"
 #include "request.hpp"
+#include "route_table.hpp"
+#include "router.hpp"
 #include "socket.hpp"
+#include "static_files.hpp"
 
 namespace http {
 
@@ -10,6 +18,29 @@ struct ServerConfig {
     std::string_view host = "localhost";
     uint16_t port = 3000;
     size_t max_threads = 8;
+    IoEngine io_engine = IoEngine::Epoll;
+    bool reuse_port = false;
+    bool pin_threads = false;
+    // 코어마다 고정된 워커가 리스너, 연결, 버퍼, 통계를 독점한다
+    bool thread_per_core = false;
+    // 동시 연결 상한, 넘는 연결은 accept 직후 닫는다
+    size_t max_connections = 65536;
+    // 유휴 연결, 헤더 수신, 본문 수신에 허용하는 시간
+    std::chrono::milliseconds idle_timeout = std::chrono::seconds(60);
+    std::chrono::milliseconds header_timeout = std::chrono::seconds(10);
+    std::chrono::milliseconds body_timeout = std::chrono::seconds(60);
+    size_t max_requests_per_connection = 1000;  // 0 이면 제한 없음
+    // 비어 있지 않으면 이 디렉터리의 파일을 핸들러보다 먼저 응답한다
+    std::string_view document_root = "";
+    // 0 보다 크면 핸들러 응답의 검증자를 이 시간 동안 기억해 두고, 맞는
+    // 재검증 요청에는 핸들러를 부르지 않고 304 로 답한다
+    std::chrono::milliseconds validator_cache_ttl{0};
+    // Accept-Encoding 에 맞춰 text/* 와 JSON 응답을 gzip, deflate 로 압축한다
+    bool compression = false;
+    int32_t compression_level = 6;         // zlib 압축 수준, 1 ~ 9
+    size_t compression_min_size = 1024;    // 이보다 작은 본문은 그대로 보낸다
+    // 워커 스레드마다 압축 결과를 기억해 두는 최대 바이트 수
+    size_t compression_cache_size = 16 * 1024 * 1024;
 };
 
 class Server {
@@ -24,15 +55,142 @@ public:
     Server& operator=(Server&) = delete;
 
     void listen();
+
+    /**
+     * Starts the server like `listen()`, answering every request that no
+     * static file or route answers with `handler(Request&&)`. The handler
+     * returns a `Response` and is compiled into the request path and called
+     * directly, without `std::function` or a vector of responses.
+     */
+    template <typename Handler>
+    void serve(Handler&& handler) {
+        using Stored = std::decay_t<Handler>;
+        // 워커가 모두 멈출 때까지 살아 있도록 서버가 핸들러를 갖는다
+        self.serving = std::make_shared<Stored>(std::forward<Handler>(handler));
+        self.start(ReceiveHandler{this,
+            [](void* context, Request&& request, ResponseSink& sink) {
+                Server& server = *static_cast<Server*>(context);
+                server.respond(std::move(request), sink,
+                    *static_cast<Stored*>(server.serving.get()));
+            }});
+    }
+
+    /**
+     * Handles every request that no static file or route answers, for
+     * `listen()`. Prefer `serve()`, which calls its handler directly.
+     */
     void on_receive(std::function<std::vector<Response>(Request&&)> func);
 
+    /**
+     * Routes `method` requests matching `pattern` to `handler`; see `Router`
+     * for the pattern syntax. Requests no route matches go to the
+     * `on_receive` handler, or get 404, or 405 when only the method differs.
+     */
+    void route(Method method, std::string_view pattern, RouteHandler handler);
+
+    /**
+     * Answers requests from the compile-time `RouteTable` `Table` before the
+     * runtime routes, calling its handlers directly.
+     */
+    template <typename Table>
+    void routes() {
+        self.route_table = &Table::dispatch;
+    }
+
     std::string_view get_host() const noexcept;
+#ifndef _WIN32
+    SocketStats stats() const noexcept;
+#endif
+
+private:
+    // 한 요청의 응답을 마무리하는 데 필요한 요청 헤더와 설정
+    struct Exchange {
+        std::string_view target;
+        bool head = false;
+        bool conditional = false;  // GET 이나 HEAD
+        bool revalidating = false;
+        bool cache_validators = false;
+        std::optional<std::string_view> if_none_match;
+        std::optional<std::string_view> if_modified_since;
+        std::optional<std::string_view> range;
+        std::optional<std::string_view> if_range;
+        ContentEncoding encoding = ContentEncoding::Identity;
+        std::chrono::steady_clock::time_point now;
+    };
+
+    template <typename Handler>
+    static bool has_handler(const Handler& handler) noexcept {
+        // std::function 과 함수 포인터는 비어 있을 수 있다
+        if constexpr (std::is_constructible_v<bool, const Handler&>) {
+            return static_cast<bool>(handler);
+        } else {
+            return true;
+        }
+    }
+
+    /**
+     * Answers `request` from the validator cache, a static file, the routes
+     * or `handler`, in that order, and puts the finished response in `sink`.
+     */
+    template <typename Handler>
+    void respond(Request&& request, ResponseSink& sink, Handler& handler) {
+        Exchange exchange = self.begin(request);
+
+        std::optional<Response> response =
+            self.respond_without_handler(request, exchange);
+        bool from_handler = !response.has_value();
+        if (!response.has_value()) {
+            response =
+                self.dispatch_routes(request, Server::has_handler(handler));
+        }
+
+        if (!response.has_value() && Server::has_handler(handler)) {
+            using Result = std::invoke_result_t<Handler&, Request&&>;
+            if constexpr (std::is_same_v<Result, std::vector<Response>>) {
+                // on_receive 핸들러는 응답 여러 개를 돌려줄 수 있다
+                std::vector<Response> responses = handler(std::move(request));
+                for (size_t i = 0; i < responses.size(); ++i) {
+                    self.finish(responses[i], exchange, responses.size() == 1);
+                    sink.send(responses[i], i + 1 == responses.size());
+                }
+                return;
+            } else {
+                response = handler(std::move(request));
+            }
+        }
+
+        if (!response.has_value()) {
+            response = self.not_found(request);
+        }
+        self.finish(response.value(), exchange, from_handler);
+        sink.send(response.value());
+    }
+
+    void start(ReceiveHandler receive);
+    Exchange begin(const Request& request) const;
+    std::optional<Response> respond_without_handler(
+        const Request& request, const Exchange& exchange);
+    std::optional<Response> dispatch_routes(Request& request, bool has_handler);
+    Response not_found(const Request& request) const;
+    void finish(
+        Response& response, const Exchange& exchange, bool from_handler);
+    // 200 응답에 검증자, 압축, 304 와 Range 를 적용한다
+    void finish_ok(
+        Response& response, const Exchange& exchange, bool from_handler);
 
 private:
     Server& self = *this;
 
+    // serve() 에 넘긴 핸들러, 워커를 멈추는 socket 보다 늦게 해제된다
+    std::shared_ptr<void> serving;
     Socket socket;
     ServerConfig config;
+    std::unique_ptr<StaticFiles> static_files;
+    std::unique_ptr<Compressor> compressor;
+    // 컴파일 시간 라우트 테이블의 dispatch, 없으면 nullptr
+    std::optional<Response> (*route_table)(const Server&, Request&) = nullptr;
+    Router router;
+    std::function<std::vector<Response>(Request&&)> handler;
 };
 
 }  // namespace http
\ No newline at end of file
@@ -0,0 +1,194 @@
+#pragma once
+
+#include <bit>
+#include <cstddef>
+#include <cstdint>
+#include <string_view>
+#include <utility>
+#include "log.hpp"
+
+#if defined(__x86_64__) || defined(_M_X64)
+    #define HTTP_SIMD_X86
+
+    #include <immintrin.h>
+    #ifdef _WIN32
+        #include <intrin.h>
+    #endif
+#endif
+
+namespace http {
+
+enum struct ScanLevel { Scalar, Sse42, Avx2 };
+
+/**
+ * Byte scanners used by `RequestParser`. Each returns the offset of the first
+ * byte in its stop set, or `size` when there is none.
+ */
+struct ScanKernels {
+    ScanLevel level;
+    // CTL (0x00-0x1f, 0x7f): 헤더 값과 줄 끝
+    size_t (*find_control)(const char* data, size_t size) noexcept;
+    // CTL, SP: 요청 대상
+    size_t (*find_delimiter)(const char* data, size_t size) noexcept;
+    // CTL, SP, ':': 헤더 이름
+    size_t (*find_field_name_end)(const char* data, size_t size) noexcept;
+};
+
+std::string_view scan_level_to_string(ScanLevel level) {
+    LOG_TRACE("http::scan_level_to_string()");
+    using namespace std::string_view_literals;
+    switch (level) {
+        case ScanLevel::Scalar:
+            return "scalar"sv;
+        case ScanLevel::Sse42:
+            return "sse4.2"sv;
+        case ScanLevel::Avx2:
+            return "avx2"sv;
+        default:
+            std::unreachable();
+    }
+}
+
+namespace detail {
+
+// [0x00, Max], 0x7f, Extra 가 멈출 바이트다
+template <uint8_t Max, char Extra>
+constexpr bool is_stop_byte(char c) noexcept {
+    uint8_t u = static_cast<uint8_t>(c);
+    return u <= Max || u == 0x7f || c == Extra;
+}
+
+template <uint8_t Max, char Extra>
+size_t scan_scalar(const char* data, size_t size) noexcept {
+    size_t i = 0;
+    while (i < size && !is_stop_byte<Max, Extra>(data[i])) {
+        ++i;
+    }
+    return i;
+}
+
+#ifdef HTTP_SIMD_X86
+template <uint8_t Max, char Extra>
+__attribute__((target("sse4.2"))) size_t scan_sse42(
+    const char* data, size_t size) noexcept {
+    const __m128i ranges = _mm_setr_epi8(0, static_cast<char>(Max), 0x7f,
+        0x7f, Extra, Extra, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0);
+
+    size_t i = 0;
+    for (; i + 16 <= size; i += 16) {
+        __m128i chunk =
+            _mm_loadu_si128(reinterpret_cast<const __m128i*>(data + i));
+        int32_t index = _mm_cmpestri(ranges, 6, chunk, 16,
+            _SIDD_UBYTE_OPS | _SIDD_CMP_RANGES | _SIDD_LEAST_SIGNIFICANT);
+        if (index != 16) {
+            return i + static_cast<size_t>(index);
+        }
+    }
+
+    return i + scan_scalar<Max, Extra>(data + i, size - i);
+}
+
+template <uint8_t Max, char Extra>
+__attribute__((target("avx2"))) size_t scan_avx2(
+    const char* data, size_t size) noexcept {
+    const __m256i max = _mm256_set1_epi8(static_cast<char>(Max));
+    const __m256i del = _mm256_set1_epi8(0x7f);
+    const __m256i extra = _mm256_set1_epi8(Extra);
+
+    size_t i = 0;
+    for (; i + 32 <= size; i += 32) {
+        __m256i chunk =
+            _mm256_loadu_si256(reinterpret_cast<const __m256i*>(data + i));
+
+        // 부호 없는 비교가 없으므로 min(chunk, Max) == chunk 로 chunk <= Max 를 구한다
+        __m256i stop = _mm256_or_si256(
+            _mm256_cmpeq_epi8(_mm256_min_epu8(chunk, max), chunk),
+            _mm256_or_si256(
+                _mm256_cmpeq_epi8(chunk, del), _mm256_cmpeq_epi8(chunk, extra)));
+
+        uint32_t mask = static_cast<uint32_t>(_mm256_movemask_epi8(stop));
+        if (mask != 0) {
+            return i + static_cast<size_t>(std::countr_zero(mask));
+        }
+    }
+
+    return i + scan_scalar<Max, Extra>(data + i, size - i);
+}
+
+    #ifdef _WIN32
+__attribute__((target("xsave"))) ScanLevel detect_scan_level() noexcept {
+    int32_t info[4];
+    __cpuid(info, 1);
+    bool sse42 = (info[2] & (1 << 20)) != 0;
+    bool avx = (info[2] & (1 << 28)) != 0;
+    bool osxsave = (info[2] & (1 << 27)) != 0;
+
+    // AVX2 는 OS 가 YMM 레지스터를 저장할 때만 쓸 수 있다
+    bool ymm = osxsave && avx && (_xgetbv(0) & 6) == 6;
+    __cpuidex(info, 7, 0);
+    bool avx2 = ymm && (info[1] & (1 << 5)) != 0;
+
+    if (avx2) {
+        return ScanLevel::Avx2;
+    }
+    return sse42 ? ScanLevel::Sse42 : ScanLevel::Scalar;
+}
+    #else
+ScanLevel detect_scan_level() noexcept {
+    __builtin_cpu_init();
+    if (__builtin_cpu_supports("avx2")) {
+        return ScanLevel::Avx2;
+    }
+    if (__builtin_cpu_supports("sse4.2")) {
+        return ScanLevel::Sse42;
+    }
+    return ScanLevel::Scalar;
+}
+    #endif
+#else
+ScanLevel detect_scan_level() noexcept {
+    return ScanLevel::Scalar;
+}
+#endif
+
+}  // namespace detail
+
+/**
+ * Returns the kernels for `level`, falling back to the best level below it
+ * that this build supports. Does not check the CPU.
+ */
+ScanKernels scan_kernels(ScanLevel level) noexcept {
+#ifdef HTTP_SIMD_X86
+    switch (level) {
+        case ScanLevel::Avx2:
+            return ScanKernels{ScanLevel::Avx2, detail::scan_avx2<0x1f, 0x7f>,
+                detail::scan_avx2<0x20, 0x7f>, detail::scan_avx2<0x20, ':'>};
+        case ScanLevel::Sse42:
+            return ScanKernels{ScanLevel::Sse42,
+                detail::scan_sse42<0x1f, 0x7f>, detail::scan_sse42<0x20, 0x7f>,
+                detail::scan_sse42<0x20, ':'>};
+        default:
+            break;
+    }
+#endif
+    return ScanKernels{ScanLevel::Scalar, detail::scan_scalar<0x1f, 0x7f>,
+        detail::scan_scalar<0x20, 0x7f>, detail::scan_scalar<0x20, ':'>};
+}
+
+// 시작할 때 CPU 를 한 번 확인해 고른다
+static ScanKernels SCAN_KERNELS = scan_kernels(detail::detect_scan_level());
+
+/**
+ * The level the parser runs at. Only the microbenchmark lowers it, to compare
+ * kernels; it must not change while requests are being parsed.
+ */
+ScanLevel scan_level() noexcept {
+    return SCAN_KERNELS.level;
+}
+
+void set_scan_level(ScanLevel level) noexcept {
+    ScanLevel supported = detail::detect_scan_level();
+    SCAN_KERNELS = scan_kernels(level < supported ? level : supported);
+}
+
+}  // namespace http
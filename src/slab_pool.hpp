@@ -0,0 +1,158 @@
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <cstddef>
+#include <memory>
+#include <new>
+#include <thread>
+#include <utility>
+#include <vector>
+#include "log.hpp"
+
+namespace http {
+
+static constexpr size_t SLAB_OBJECT_COUNT = 64;
+
+/**
+ * Fixed-size object pool owned by one thread. Objects are carved from slabs
+ * of `SLAB_OBJECT_COUNT` slots that are never returned to the allocator while
+ * the pool lives, and at most `max_objects` (rounded up to whole slabs) exist
+ * at once; `create()` returns nullptr beyond that.
+ *
+ * Only the owning thread, the one that constructed the pool, may call
+ * `create()`. `destroy()` may be called from any thread: a slot freed
+ * elsewhere is pushed onto a lock-free list that the owner takes over the
+ * next time its own list runs dry.
+ *
+ * Objects still alive when the owner stops can be walked with `for_each()`
+ * and destroyed there, since the pool itself does not destroy them.
+ */
+template <typename T>
+class SlabPool {
+public:
+    explicit SlabPool(size_t max_objects)
+        : max_slabs(
+              std::max<size_t>(1, (max_objects + SLAB_OBJECT_COUNT - 1) /
+                                      SLAB_OBJECT_COUNT)) {
+        LOG_TRACE("http::SlabPool()");
+    }
+
+    SlabPool(SlabPool&) = delete;
+    SlabPool& operator=(SlabPool&) = delete;
+
+    // 남아 있는 객체는 소유자가 먼저 destroy 해야 한다
+    ~SlabPool() = default;
+
+    template <typename... Args>
+    T* create(Args&&... args) {
+        Slot* slot = self.pop_free();
+        if (slot == nullptr) {
+            return nullptr;
+        }
+
+        try {
+            T* object = new (slot->storage) T{std::forward<Args>(args)...};
+            slot->live = true;
+            return object;
+        } catch (...) {
+            self.push_free(slot);
+            throw;
+        }
+    }
+
+    static void destroy(T* object) noexcept {
+        // storage 가 Slot 의 첫 멤버이므로 주소가 같다
+        Slot* slot = reinterpret_cast<Slot*>(object);
+        SlabPool& pool = *slot->owner;
+
+        object->~T();
+        slot->live = false;
+
+        if (std::this_thread::get_id() == pool.owner_thread) {
+            pool.push_free(slot);
+            return;
+        }
+
+        Slot* head = pool.remote_free.load(std::memory_order_relaxed);
+        do {
+            slot->next = head;
+        } while (!pool.remote_free.compare_exchange_weak(head, slot,
+            std::memory_order_release, std::memory_order_relaxed));
+    }
+
+    /**
+     * Calls `func` with every live object; `func` may destroy it. Only the
+     * owner may call this, once no other thread destroys objects.
+     */
+    template <typename F>
+    void for_each(F&& func) {
+        for (std::unique_ptr<Slot[]>& slab : self.slabs) {
+            for (size_t i = 0; i < SLAB_OBJECT_COUNT; ++i) {
+                if (slab[i].live) {
+                    func(*std::launder(reinterpret_cast<T*>(slab[i].storage)));
+                }
+            }
+        }
+    }
+
+    size_t capacity() const noexcept {
+        return self.max_slabs * SLAB_OBJECT_COUNT;
+    }
+
+private:
+    struct Slot {
+        alignas(T) std::byte storage[sizeof(T)];
+        Slot* next;
+        SlabPool* owner;
+        bool live;  // 객체가 생성되어 있다
+    };
+
+    Slot* pop_free() {
+        if (self.free_list == nullptr) {
+            // 다른 스레드에서 반환된 슬롯을 한 번에 가져온다
+            self.free_list =
+                self.remote_free.exchange(nullptr, std::memory_order_acquire);
+        }
+
+        if (self.free_list == nullptr) {
+            if (self.slabs.size() == self.max_slabs) {
+                return nullptr;
+            }
+            self.add_slab();
+        }
+
+        Slot* slot = self.free_list;
+        self.free_list = slot->next;
+        return slot;
+    }
+
+    void push_free(Slot* slot) noexcept {
+        slot->next = self.free_list;
+        self.free_list = slot;
+    }
+
+    void add_slab() {
+        std::unique_ptr<Slot[]> slab =
+            std::make_unique_for_overwrite<Slot[]>(SLAB_OBJECT_COUNT);
+
+        // 앞쪽 슬롯부터 쓰도록 뒤에서부터 넣는다
+        for (size_t i = SLAB_OBJECT_COUNT; i > 0; --i) {
+            slab[i - 1].owner = this;
+            slab[i - 1].live = false;
+            self.push_free(&slab[i - 1]);
+        }
+        self.slabs.push_back(std::move(slab));
+    }
+
+private:
+    SlabPool& self = *this;
+
+    std::vector<std::unique_ptr<Slot[]>> slabs;
+    Slot* free_list = nullptr;              // 소유 스레드만 만진다
+    std::atomic<Slot*> remote_free = nullptr;  // 다른 스레드에서 반환된 슬롯
+    std::thread::id owner_thread = std::this_thread::get_id();
+    size_t max_slabs;
+};
+
+}  // namespace http
@@ -1,9 +1,22 @@
 #include "socket.hpp"
 #include "log.hpp"
+#include "request.hpp"
 #include "response.hpp"
 
 namespace http {
 
+/**
+ * Tells the client whether the connection stays open after `response`. An
+ * HTTP/1.0 client closes it unless told to keep it.
+ */
+static void set_connection(Response& response, bool closing) {
+    if (closing) {
+        response.fields["Connection"] = "close";
+    } else if (response.http_version == HttpVersion::Http1_0) {
+        response.fields["Connection"] = "keep-alive";
+    }
+}
+
 #ifdef _WIN32
 
 Socket::Socket() noexcept : config(SocketConfig{}) {
@@ -112,10 +125,23 @@ void Socket::init() {
     //         "Cannot register socket to IOCP: {}", WSAGetLastError()));
     // }
 
+    // IOCP 는 포트 하나를 공유하므로 코어당 고정된 워커만 맞춰준다
+    if (self.config.thread_per_core) {
+        self.config.max_threads =
+            std::max(std::thread::hardware_concurrency(), 1u);
+        self.config.pin_threads = true;
+    }
+
     self.worker_threads.reserve(self.config.max_threads);
     for (size_t i = 0; i < self.config.max_threads; ++i) {
         // self.worker_threads.emplace_back(&Socket::worker_thread, this);
-        self.worker_threads.emplace_back([this]() { this->worker_thread(); });
+        self.worker_threads.emplace_back([this, i]() {
+            if (this->config.pin_threads) {
+                SetThreadAffinityMask(GetCurrentThread(),
+                    DWORD_PTR{1} << (i % (sizeof(DWORD_PTR) * 8)));
+            }
+            this->worker_thread();
+        });
     }
 
     self.ready = true;
@@ -129,6 +155,9 @@ void Socket::listen() {
         return;
     }
 
+    // 연결은 이 스레드에서 만들고 IOCP 워커에서 해제된다
+    self.clients.emplace(self.config.max_connections);
+
     while (true) {
         SOCKADDR_IN client_address;
         int32_t address_length = sizeof(client_address);
@@ -140,10 +169,16 @@ void Socket::listen() {
             continue;
         }
 
-        ClientContext* client_context = new ClientContext{};
+        ClientContext* client_context = self.clients->create();
+        if (client_context == nullptr) {
+            LOG_WARN("Connection limit reached, closing new connection");
+            closesocket(client_socket);
+            continue;
+        }
         client_context->socket = client_socket;
-        client_context->wsabuf.buf = client_context->buffer;
-        client_context->wsabuf.len = BUFFER_SIZE;
+        std::span<char> space = client_context->input.prepare(BUFFER_SIZE);
+        client_context->wsabuf.buf = space.data();
+        client_context->wsabuf.len = static_cast<ULONG>(space.size());
 
         if (CreateIoCompletionPort(reinterpret_cast<HANDLE>(client_socket),
                 self.iocp, reinterpret_cast<ULONG_PTR>(client_context),
@@ -156,34 +191,113 @@ void Socket::listen() {
         int32_t receive_result = WSARecv(client_socket, &client_context->wsabuf,
             1, nullptr, &flags, &client_context->overlapped, nullptr);
 
+        if (receive_result == SOCKET_ERROR &&
+            WSAGetLastError() != WSA_IO_PENDING) {
+            LOG_ERROR(
+                "Failed to receive data from client: {}", WSAGetLastError());
+            self.release_client(client_context);
+            continue;
+        }
+
         if (self.listeners.on_connect) {
             self.listeners.on_connect();
         }
-
-        using namespace std::chrono_literals;
-        std::this_thread::sleep_for(1ms);
     }
 }
 
 void Socket::send(ClientContext* client_context, std::string_view message) {
-    size_t buffer_size = message.size();
-    char* send_buffer = new char[buffer_size];
-    std::memcpy(send_buffer, message.data(), buffer_size);
-    client_context->wsabuf.buf = send_buffer;
-    client_context->wsabuf.len = buffer_size;
+    // 풀 버퍼 하나에 들어가지 않는 메시지는 나눠 보낸다. 같은 소켓의 송신은
+    // 건 순서대로 나간다
+    while (!message.empty()) {
+        char* buffer = BufferPool::local().acquire();
+        SendContext* send_context = new (buffer) SendContext{};
+        char* data = buffer + sizeof(SendContext);
+        size_t size = std::min(message.size(), SEND_BUFFER_CAPACITY);
 
-    DWORD bytes_sent = 0;
-    DWORD flags = 0;
+        std::memcpy(data, message.data(), size);
+        send_context->wsabuf.buf = data;
+        send_context->wsabuf.len = static_cast<ULONG>(size);
+        send_context->client_context = client_context;
+        client_context->references.fetch_add(1, std::memory_order_relaxed);
+        client_context->unsent.fetch_add(size, std::memory_order_relaxed);
 
-    int32_t result = WSASend(client_context->socket, &client_context->wsabuf, 1,
-        &bytes_sent, flags, &client_context->overlapped, nullptr);
+        int32_t result = WSASend(client_context->socket, &send_context->wsabuf,
+            1, nullptr, 0, &send_context->overlapped, nullptr);
 
-    if (result == SOCKET_ERROR && WSAGetLastError() != WSA_IO_PENDING) {
+        if (result == SOCKET_ERROR && WSAGetLastError() != WSA_IO_PENDING) {
+            LOG_ERROR("Failed to send data to client: {}", WSAGetLastError());
+            // 완료 통지가 오지 않으므로 바로 돌려준다
+            self.complete_send(send_context, 0, false);
+            return;
+        }
+
+        message.remove_prefix(size);
+    }
+}
+
+void Socket::complete_send(
+    SendContext* send_context, DWORD bytes_sent, bool succeeded) {
+    ClientContext* client_context = send_context->client_context;
+
+    // 일부만 나갔으면 같은 SendContext 로 나머지를 이어 보낸다
+    if (succeeded && bytes_sent < send_context->wsabuf.len) {
+        client_context->unsent.fetch_sub(bytes_sent, std::memory_order_relaxed);
+        send_context->wsabuf.buf += bytes_sent;
+        send_context->wsabuf.len -= bytes_sent;
+        ZeroMemory(&send_context->overlapped, sizeof(OVERLAPPED));
+
+        int32_t result = WSASend(client_context->socket, &send_context->wsabuf,
+            1, nullptr, 0, &send_context->overlapped, nullptr);
+        if (result != SOCKET_ERROR || WSAGetLastError() == WSA_IO_PENDING) {
+            return;
+        }
         LOG_ERROR("Failed to send data to client: {}", WSAGetLastError());
-        closesocket(client_context->socket);
+        succeeded = false;
+    }
+
+    if (!succeeded) {
+        // 수신 쪽 완료에서 연결을 정리하도록 양방향을 닫는다
+        shutdown(client_context->socket, SD_BOTH);
+    }
+
+    size_t unsent =
+        client_context->unsent.fetch_sub(send_context->wsabuf.len,
+            std::memory_order_acq_rel) -
+        send_context->wsabuf.len;
+
+    // 밀린 송신이 줄었으면 멈춰 둔 수신을 다시 건다
+    if (unsent <= OUTPUT_LOW_WATERMARK &&
+        client_context->paused.exchange(false, std::memory_order_acq_rel)) {
+        self.post_receive(client_context);
     }
 
-    delete[] send_buffer;
+    send_context->~SendContext();
+    BufferPool::local().release(reinterpret_cast<char*>(send_context));
+    self.release_client(client_context);
+}
+
+void Socket::post_receive(ClientContext* client_context) {
+    std::span<char> space = client_context->input.prepare(BUFFER_SIZE);
+    client_context->wsabuf.buf = space.data();
+    client_context->wsabuf.len = static_cast<ULONG>(space.size());
+    ZeroMemory(&client_context->overlapped, sizeof(OVERLAPPED));
+
+    DWORD flags = 0;
+    int32_t result = WSARecv(client_context->socket, &client_context->wsabuf,
+        1, nullptr, &flags, &client_context->overlapped, nullptr);
+
+    if (result == SOCKET_ERROR && WSAGetLastError() != WSA_IO_PENDING) {
+        LOG_ERROR("Failed to receive data from client: {}", WSAGetLastError());
+        self.release_client(client_context);
+    }
+}
+
+void Socket::release_client(ClientContext* client_context) {
+    if (client_context->references.fetch_sub(1, std::memory_order_acq_rel) ==
+        1) {
+        closesocket(client_context->socket);
+        ClientPool::destroy(client_context);
+    }
 }
 
 void Socket::on_connect(std::function<void()> func) {
@@ -194,9 +308,7 @@ void Socket::on_disconnect(std::function<void()> func) {
     LOG_TRACE("http::Socket::on_disconnect()");
     self.listeners.on_disconnect = func;
 }
-void Socket::on_receive(
-    std::function<std::optional<std::vector<Response>>(std::string_view)>
-        func) {
+void Socket::on_receive(ReceiveHandler func) {
     LOG_TRACE("http::Socket::on_receive()");
     self.listeners.on_receive = func;
 }
@@ -237,62 +349,1508 @@ void Socket::worker_thread() {
             reinterpret_cast<PULONG_PTR>(&client_context), &overlapped,
             INFINITE);
 
+        if (overlapped == nullptr) {
+            continue;
+        }
+
+        // 송신 완료는 자기 SendContext 만 정리하고 수신을 다시 걸지 않는다
+        if (overlapped != &client_context->overlapped) {
+            SendContext* send_context =
+                CONTAINING_RECORD(overlapped, SendContext, overlapped);
+            self.complete_send(
+                send_context, bytes_transferred, result != FALSE);
+            continue;
+        }
+
         if (result == FALSE || bytes_transferred == 0) {
-            if (client_context != nullptr) {
-                if (self.listeners.on_disconnect) {
-                    self.listeners.on_disconnect();
-                }
-                LOG_ERROR("Client disconnected or error occurred");
-                closesocket(client_context->socket);
-                delete client_context;
+            if (self.listeners.on_disconnect) {
+                self.listeners.on_disconnect();
             }
+            LOG_ERROR("Client disconnected or error occurred");
+            self.release_client(client_context);
             continue;
         }
 
-        if (overlapped == &client_context->overlapped) {
-            std::string received_data(
-                client_context->buffer, bytes_transferred);
+        InputBuffer& input = client_context->input;
+        input.commit(bytes_transferred);
+
+        LOG_TRACE("Received data: {}", input.data());
+
+        // 지난 응답은 모두 송신 버퍼로 복사되었으므로 아레나를 비운다
+        client_context->arena.reset();
+        Arena::Scope arena_scope(client_context->arena);
 
-            LOG_TRACE("Received data: {}", received_data);
+        // 완성된 요청만 처리하고 나머지는 다음 수신까지 남겨둔다
+        ParseResult parse_result{ParseStatus::Incomplete};
+        bool closing = false;
+        while (!input.empty()) {
+            Request request{};
+            parse_result =
+                client_context->parser.parse(input.mutable_data(), request);
 
+            if (parse_result.status != ParseStatus::Complete) {
+                break;
+            }
+
+            // 클라이언트가 닫기를 바라면 이 응답 뒤의 요청은 버린다
+            closing = !request.keep_alive();
+
+            // 응답은 요청 순서대로 모았다가 한 번에 보낸다
             if (self.listeners.on_receive) {
-                std::optional<std::vector<Response>> responses =
-                    self.listeners.on_receive(std::string_view(received_data));
-
-                if (responses.has_value()) {
-                    auto r = responses.value();
-                    for (const Response& response : r) {
-                        std::string message =
-                            Response::response_to_message(response);
-                        LOG_TRACE("Sending response: {}", message);
-                        self.send(client_context, message);
-                    }
-                }
+                ResponseSink sink(client_context->output, closing);
+                self.listeners.on_receive.call(
+                    self.listeners.on_receive.context, std::move(request),
+                    sink);
             }
 
-            memset(client_context->buffer, 0, BUFFER_SIZE);
-            client_context->wsabuf.buf = client_context->buffer;
-            client_context->wsabuf.len = BUFFER_SIZE;
-            ZeroMemory(&client_context->overlapped, sizeof(OVERLAPPED));
+            input.consume(parse_result.consumed);
+            if (closing) {
+                break;
+            }
         }
 
-        DWORD flags = 0;
+        if (parse_result.status == ParseStatus::Error) {
+            LOG_ERROR("Invalid request ({}), closing connection",
+                parse_error_to_string(parse_result.error));
+            client_context->output += Response::error_to_message(
+                parse_error_to_http_code(parse_result.error));
+            closing = true;
+        }
 
-        int32_t recv_result =
-            WSARecv(client_context->socket, &client_context->wsabuf, 1, nullptr,
-                &flags, &client_context->overlapped, nullptr);
+        if (!client_context->output.empty()) {
+            LOG_TRACE("Sending response: {}", client_context->output);
+            self.send(client_context, client_context->output);
+            client_context->output.clear();
+        }
 
-        if (recv_result == SOCKET_ERROR &&
-            WSAGetLastError() != WSA_IO_PENDING) {
-            LOG_ERROR(
-                "Failed to receive data from client: {}", WSAGetLastError());
-            closesocket(client_context->socket);
-            delete client_context;
+        if (closing) {
+            // 마지막 응답이 나간 뒤 FIN 을 보내고, 남은 송신이 끝나면 해제된다
+            if (self.listeners.on_disconnect) {
+                self.listeners.on_disconnect();
+            }
+            shutdown(client_context->socket, SD_SEND);
+            self.release_client(client_context);
+            continue;
+        }
+
+        // 클라이언트가 응답을 읽지 않으면 송신이 줄어들 때까지 수신을 멈춘다.
+        // 수신 참조는 그대로 두고 complete_send 에서 다시 건다
+        if (client_context->unsent.load(std::memory_order_acquire) >
+            OUTPUT_HIGH_WATERMARK) {
+            client_context->paused.store(true, std::memory_order_release);
+
+            // 그 사이 송신이 모두 끝났으면 complete_send 가 재개하지 못했다
+            if (client_context->unsent.load(std::memory_order_acquire) >
+                    OUTPUT_LOW_WATERMARK ||
+                !client_context->paused.exchange(
+                    false, std::memory_order_acq_rel)) {
+                continue;
+            }
+        }
+
+        self.post_receive(client_context);
+    }
+}
+
+// 스트림 응답을 한 메시지로 만든다. 길이를 모르면 끝까지 모아서 길이를 붙인다
+static std::string stream_to_message(Response& response) {
+    if (!response.stream->length.has_value()) {
+        std::string collected;
+        size_t written = 0;
+        do {
+            size_t size = collected.size();
+            collected.resize(size + POOL_BUFFER_SIZE);
+            written = response.stream->next(
+                std::span<char>(collected.data() + size, POOL_BUFFER_SIZE));
+            collected.resize(size + written);
+        } while (written != 0);
+        response.set_body(std::move(collected));
+    }
+    return Response::response_to_message(response);
+}
+
+void ResponseSink::send(Response& response, bool last) {
+    if (last) {
+        set_connection(response, self.closing);
+    }
+
+    // 스트림이 던지면 이 응답은 버리고 Linux 처럼 연결을 닫는다
+    if (response.stream.has_value()) {
+        try {
+            self.output += stream_to_message(response);
+        } catch (const std::exception& e) {
+            LOG_ERROR("Stream body threw: {}", e.what());
+            self.closing = true;
+        } catch (...) {
+            LOG_ERROR("Stream body threw");
+            self.closing = true;
         }
+        return;
+    }
+
+    // 파일과 여러 구간은 IOCP 송신 버퍼로 모아 보낸다
+    if (response.file.has_value() || !response.parts.empty()) {
+        self.output += Response::response_to_message(response);
+        return;
     }
+
+    size_t offset = self.output.size();
+    self.output.resize(offset + Response::head_size(response));
+    Response::write_head(response, self.output.data() + offset);
+    self.output += response.body;
 }
 #else
 
+/**
+ * Returns the CPU worker `index` is pinned to: the `index`-th CPU the calling
+ * thread is allowed to run on, wrapping around, or -1 when none is known.
+ */
+static int32_t worker_cpu(size_t index) noexcept {
+    cpu_set_t allowed;
+    CPU_ZERO(&allowed);
+
+    if (sched_getaffinity(0, sizeof(allowed), &allowed) != 0) {
+        return -1;
+    }
+
+    size_t count = static_cast<size_t>(CPU_COUNT(&allowed));
+    if (count == 0) {
+        return -1;
+    }
+
+    size_t target = index % count;
+    for (int32_t cpu = 0; cpu < CPU_SETSIZE; ++cpu) {
+        if (CPU_ISSET(cpu, &allowed) && target-- == 0) {
+            return cpu;
+        }
+    }
+
+    return -1;
+}
+
+/**
+ * Pins the calling thread to `worker_cpu(index)` and returns that CPU, or -1
+ * when the affinity cannot be changed.
+ */
+static int32_t pin_current_thread(size_t index) noexcept {
+    int32_t cpu = worker_cpu(index);
+    if (cpu < 0) {
+        return -1;
+    }
+
+    cpu_set_t pinned;
+    CPU_ZERO(&pinned);
+    CPU_SET(cpu, &pinned);
+
+    if (pthread_setaffinity_np(pthread_self(), sizeof(pinned), &pinned) != 0) {
+        LOG_WARN("Failed to pin worker {} to cpu {}", index, cpu);
+        return -1;
+    }
+    return cpu;
+}
+
+static size_t available_cpu_count() noexcept {
+    cpu_set_t allowed;
+    CPU_ZERO(&allowed);
+
+    if (sched_getaffinity(0, sizeof(allowed), &allowed) == 0) {
+        return static_cast<size_t>(CPU_COUNT(&allowed));
+    }
+    return std::max(std::thread::hardware_concurrency(), 1u);
+}
+
+/**
+ * Migrates `memory` to NUMA node `node` and makes the node preferred for pages
+ * that are faulted in later.
+ */
+static void move_to_numa_node(std::span<char> memory, int32_t node) noexcept {
+    if (node < 0 || node >= 64 || memory.empty()) {
+        return;
+    }
+
+    unsigned long node_mask = 1ul << node;
+    if (syscall(SYS_mbind, memory.data(), memory.size(), MPOL_PREFERRED,
+            &node_mask, sizeof(node_mask) * 8, MPOL_MF_MOVE) != 0) {
+        LOG_WARN("Failed to move worker memory to NUMA node {}: {}", node,
+            std::strerror(errno));
+    }
+}
+
+/**
+ * Steers each new connection to the SO_REUSEPORT listener of the worker
+ * pinned to the CPU that received the SYN, so pinned workers accept on their
+ * own core. SYNs on any other CPU are spread by CPU number.
+ */
+static void attach_cpu_steering(int listen_socket, size_t group_size) {
+    std::vector<sock_filter> code;
+    code.push_back({BPF_LD | BPF_W | BPF_ABS, 0, 0,
+        static_cast<uint32_t>(SKF_AD_OFF + SKF_AD_CPU)});
+
+    // 워커가 CPU 보다 많으면 같은 CPU 에 고정된 첫 워커로 보낸다
+    size_t pinned_count = std::min(group_size, available_cpu_count());
+    for (size_t i = 0; i < pinned_count; ++i) {
+        int32_t cpu = worker_cpu(i);
+        if (cpu < 0) {
+            break;
+        }
+        code.push_back(
+            {BPF_JMP | BPF_JEQ | BPF_K, 0, 1, static_cast<uint32_t>(cpu)});
+        code.push_back({BPF_RET | BPF_K, 0, 0, static_cast<uint32_t>(i)});
+    }
+
+    code.push_back(
+        {BPF_ALU | BPF_MOD | BPF_K, 0, 0, static_cast<uint32_t>(group_size)});
+    code.push_back({BPF_RET | BPF_A, 0, 0, 0});
+
+    sock_fprog program{
+        .len = static_cast<unsigned short>(code.size()), .filter = code.data()};
+
+    if (setsockopt(listen_socket, SOL_SOCKET, SO_ATTACH_REUSEPORT_CBPF,
+            &program, sizeof(program)) != 0) {
+        LOG_WARN("Failed to attach reuseport cpu steering: {}",
+            std::strerror(errno));
+    }
+}
+
+Socket::Socket() noexcept : config(SocketConfig{}) {
+    LOG_TRACE("http::Socket()");
+}
+Socket::Socket(SocketConfig config) noexcept : config(config) {
+    LOG_TRACE("http::Socket(SocketConfig config)");
+}
+Socket::Socket(SocketConfig&& config) noexcept : config(std::move(config)) {
+    LOG_TRACE("http::Socket(SocketConfig&& config)");
+}
+Socket::Socket(Socket&& other) noexcept : config(std::move(other.config)) {
+    LOG_TRACE("http::Socket(Socket&& other)");
+};
+
+Socket& Socket::operator=(Socket&& other) {
+    LOG_TRACE("http::Socket::operator(Socket&& other)");
+    self.config = std::move(other.config);
+    return self;
+}
+
+Socket::~Socket() {
+    LOG_TRACE("http::~Socket()");
+    if (self.ready) {
+        self.terminate();
+    }
+}
+
+void Socket::init() {
+    LOG_TRACE("http::Socket::init()");
+
+    if (self.ready) {
+        return;
+    }
+
+    if (self.config.thread_per_core) {
+        self.config.max_threads = available_cpu_count();
+        self.config.reuse_port = true;
+        self.config.pin_threads = true;
+    }
+
+    self.workers.resize(self.config.max_threads);
+    self.workers_started =
+        std::make_unique<std::latch>(self.config.max_threads);
+    self.workers_stopped =
+        std::make_unique<std::latch>(self.config.max_threads);
+
+    if (self.config.reuse_port) {
+        // 워커마다 같은 포트에 SO_REUSEPORT 리스너를 열어 커널이 분산시키게 한다
+        self.worker_sockets.reserve(self.config.max_threads);
+        for (size_t i = 0; i < self.config.max_threads; ++i) {
+            try {
+                self.worker_sockets.push_back(self.create_listen_socket());
+            } catch (...) {
+                self.ready = true;
+                self.terminate();
+                throw;
+            }
+        }
+
+        if (self.config.pin_threads) {
+            attach_cpu_steering(
+                self.worker_sockets.front(), self.worker_sockets.size());
+        }
+    } else {
+        self.socket = self.create_listen_socket();
+    }
+
+    // 종료 시 대기 중인 모든 워커를 깨우기 위한 eventfd
+    self.shutdown_event = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+
+    if (self.shutdown_event == -1) {
+        self.ready = true;
+        self.terminate();
+        throw std::runtime_error(
+            std::format("Cannot create eventfd: {}", std::strerror(errno)));
+    }
+
+    if (self.config.engine == IoEngine::IoUring) {
+        self.worker_rings.reserve(self.config.max_threads);
+        for (size_t i = 0; i < self.config.max_threads; ++i) {
+            std::unique_ptr<IoUring> ring = std::make_unique<IoUring>();
+
+            try {
+                ring->init(IO_URING_ENTRIES);
+                ring->register_buffer_ring(
+                    0, IO_URING_BUFFER_COUNT, BUFFER_SIZE);
+            } catch (...) {
+                self.ready = true;
+                self.terminate();
+                throw;
+            }
+
+            self.worker_rings.push_back(std::move(ring));
+        }
+
+        self.ready = true;
+
+        self.worker_threads.reserve(self.config.max_threads);
+        for (size_t i = 0; i < self.config.max_threads; ++i) {
+            self.worker_threads.emplace_back(
+                [this, i]() { this->io_uring_worker_thread(i); });
+        }
+        self.workers_started->wait();
+        return;
+    }
+
+    epoll_event shutdown_event{};
+    shutdown_event.events = EPOLLIN;
+    shutdown_event.data.ptr = &self.shutdown_event;
+
+    // 리스너 이벤트는 data.ptr 이 nullptr 이다
+    epoll_event listen_event{};
+    listen_event.events = EPOLLIN | EPOLLET;
+    listen_event.data.ptr = nullptr;
+
+    if (!self.config.reuse_port) {
+        self.listen_epoll = epoll_create1(EPOLL_CLOEXEC);
+
+        if (self.listen_epoll == -1) {
+            self.ready = true;
+            self.terminate();
+            throw std::runtime_error(
+                std::format("Cannot create epoll: {}", std::strerror(errno)));
+        }
+
+        epoll_ctl(self.listen_epoll, EPOLL_CTL_ADD, self.socket, &listen_event);
+        epoll_ctl(self.listen_epoll, EPOLL_CTL_ADD, self.shutdown_event,
+            &shutdown_event);
+    }
+
+    self.worker_epolls.reserve(self.config.max_threads);
+    for (size_t i = 0; i < self.config.max_threads; ++i) {
+        int epoll = epoll_create1(EPOLL_CLOEXEC);
+
+        if (epoll == -1) {
+            self.ready = true;
+            self.terminate();
+            throw std::runtime_error(
+                std::format("Cannot create epoll: {}", std::strerror(errno)));
+        }
+
+        epoll_ctl(epoll, EPOLL_CTL_ADD, self.shutdown_event, &shutdown_event);
+        if (self.config.reuse_port) {
+            epoll_ctl(
+                epoll, EPOLL_CTL_ADD, self.worker_sockets[i], &listen_event);
+        }
+        self.worker_epolls.push_back(epoll);
+    }
+
+    self.ready = true;
+
+    self.worker_threads.reserve(self.config.max_threads);
+    for (size_t i = 0; i < self.config.max_threads; ++i) {
+        self.worker_threads.emplace_back([this, i]() { this->worker_thread(i); });
+    }
+    self.workers_started->wait();
+}
+
+int Socket::create_listen_socket() {
+    LOG_TRACE("http::Socket::create_listen_socket()");
+
+    struct addrinfo *addr_info = nullptr, hints{};
+
+    hints.ai_family = AF_INET;
+    hints.ai_socktype = SOCK_STREAM;
+    hints.ai_protocol = IPPROTO_TCP;
+    hints.ai_flags = AI_PASSIVE;
+
+    int32_t addrinfo_result = getaddrinfo(nullptr,
+        (std::to_string(self.config.port)).c_str(), &hints, &addr_info);
+
+    if (addrinfo_result != 0) {
+        throw std::runtime_error(std::format("Cannot get address information: {}",
+            gai_strerror(addrinfo_result)));
+    }
+
+    // io_uring 은 블로킹 소켓에서도 비동기로 동작하므로 epoll 에만 non-blocking
+    int32_t socket_flags = SOCK_CLOEXEC;
+    if (self.config.engine == IoEngine::Epoll) {
+        socket_flags |= SOCK_NONBLOCK;
+    }
+
+    int listen_socket = ::socket(addr_info->ai_family,
+        addr_info->ai_socktype | socket_flags, addr_info->ai_protocol);
+
+    if (listen_socket == -1) {
+        freeaddrinfo(addr_info);
+        throw std::runtime_error(
+            std::format("Cannot create socket: {}", std::strerror(errno)));
+    }
+
+    int32_t reuse = 1;
+    setsockopt(
+        listen_socket, SOL_SOCKET, SO_REUSEADDR, &reuse, sizeof(reuse));
+
+    if (self.config.reuse_port &&
+        setsockopt(listen_socket, SOL_SOCKET, SO_REUSEPORT, &reuse,
+            sizeof(reuse)) != 0) {
+        int32_t error = errno;
+        freeaddrinfo(addr_info);
+        ::close(listen_socket);
+        throw std::runtime_error(
+            std::format("Cannot enable SO_REUSEPORT: {}", std::strerror(error)));
+    }
+
+    int32_t bind_result =
+        ::bind(listen_socket, addr_info->ai_addr, addr_info->ai_addrlen);
+
+    freeaddrinfo(addr_info);
+
+    if (bind_result != 0) {
+        int32_t error = errno;
+        ::close(listen_socket);
+        throw std::runtime_error(
+            std::format("Cannot bind socket: {}", std::strerror(error)));
+    }
+
+    if (::listen(listen_socket, SOMAXCONN) != 0) {
+        int32_t error = errno;
+        ::close(listen_socket);
+        throw std::runtime_error(
+            std::format("Socket listen failed: {}", std::strerror(error)));
+    }
+
+    return listen_socket;
+}
+
+void Socket::listen() {
+    LOG_TRACE("http::Socket::listen()");
+
+    if (!self.ready) {
+        std::println("Server is not ready. Initialize server first");
+        return;
+    }
+
+    if (self.config.engine == IoEngine::IoUring || self.config.reuse_port) {
+        // accept 는 각 워커에서 처리된다
+        self.ready.wait(true);
+        return;
+    }
+
+    // 연결은 이 스레드에서 만들고 각 워커에서 해제된다
+    self.accepted_clients.emplace(self.config.max_connections);
+
+    epoll_event events[16];
+
+    while (self.ready) {
+        int32_t event_count = epoll_wait(self.listen_epoll, events, 16, -1);
+
+        if (event_count == -1) {
+            if (errno == EINTR) {
+                continue;
+            }
+            LOG_ERROR("Failed to wait for connection: {}", std::strerror(errno));
+            break;
+        }
+
+        for (int32_t i = 0; i < event_count; ++i) {
+            if (events[i].data.ptr == nullptr) {
+                self.accept_clients(self.socket, std::nullopt);
+            }
+        }
+    }
+
+    // 워커가 모두 멈춘 뒤에 이 스레드가 만든 연결을 닫는다
+    self.workers_stopped->wait();
+    self.accepted_clients->for_each([this](ClientContext& client_context) {
+        self.close_client(&client_context);
+    });
+}
+
+void Socket::accept_clients(int listen_socket, std::optional<size_t> worker) {
+    // Edge-triggered 이므로 EAGAIN 이 나올 때까지 모두 accept 해야 한다
+    while (true) {
+        sockaddr_in client_address;
+        socklen_t address_length = sizeof(client_address);
+        int client_socket = accept4(listen_socket,
+            reinterpret_cast<sockaddr*>(&client_address), &address_length,
+            SOCK_NONBLOCK | SOCK_CLOEXEC);
+
+        if (client_socket == -1) {
+            if (errno == EINTR || errno == ECONNABORTED) {
+                continue;
+            }
+            if (errno != EAGAIN && errno != EWOULDBLOCK) {
+                LOG_ERROR(
+                    "Failed to accept connection: {}", std::strerror(errno));
+            }
+            return;
+        }
+
+        int32_t no_delay = 1;
+        setsockopt(client_socket, IPPROTO_TCP, TCP_NODELAY, &no_delay,
+            sizeof(no_delay));
+
+        ClientPool& pool = worker.has_value()
+                               ? *self.workers[worker.value()]->clients
+                               : *self.accepted_clients;
+        ClientContext* client_context = pool.create();
+
+        if (client_context == nullptr) {
+            LOG_WARN("Connection limit reached, closing new connection");
+            ::close(client_socket);
+            continue;
+        }
+
+        client_context->socket = client_socket;
+        if (worker.has_value()) {
+            client_context->worker = worker.value();
+            WorkerState::count(self.workers[worker.value()]->connections);
+        } else {
+            WorkerState::count(self.accepted);
+            client_context->worker = self.next_worker;
+            self.next_worker =
+                (self.next_worker + 1) % self.worker_epolls.size();
+        }
+
+        // EPOLLOUT 은 등록 직후 한 번 발생하므로 소유 워커가 첫 타임아웃을 건다
+        epoll_event event{};
+        event.events = EPOLLIN | EPOLLOUT | EPOLLRDHUP | EPOLLET;
+        event.data.ptr = client_context;
+
+        if (epoll_ctl(self.worker_epolls[client_context->worker],
+                EPOLL_CTL_ADD, client_socket, &event) == -1) {
+            LOG_ERROR("Failed to register client to epoll: {}",
+                std::strerror(errno));
+            ::close(client_socket);
+            ClientPool::destroy(client_context);
+            continue;
+        }
+
+        if (self.listeners.on_connect) {
+            self.listeners.on_connect();
+        }
+    }
+}
+
+void Socket::send(ClientContext* client_context, std::string_view message) {
+    client_context->output.append(message);
+    self.flush_output(client_context);
+}
+
+void Socket::on_connect(std::function<void()> func) {
+    LOG_TRACE("http::Socket::on_connect()");
+    self.listeners.on_connect = func;
+}
+void Socket::on_disconnect(std::function<void()> func) {
+    LOG_TRACE("http::Socket::on_disconnect()");
+    self.listeners.on_disconnect = func;
+}
+void Socket::on_receive(ReceiveHandler func) {
+    LOG_TRACE("http::Socket::on_receive()");
+    self.listeners.on_receive = func;
+}
+
+void Socket::terminate() {
+    LOG_TRACE("http::Terminate Socket");
+
+    if (!self.ready) {
+        return;
+    }
+
+    self.ready = false;
+    self.ready.notify_all();
+
+    if (self.shutdown_event != -1) {
+        eventfd_write(self.shutdown_event, 1);
+    }
+
+    self.worker_threads.clear();
+    self.worker_rings.clear();
+
+    for (int epoll : self.worker_epolls) {
+        ::close(epoll);
+    }
+    self.worker_epolls.clear();
+
+    if (self.listen_epoll != -1) {
+        ::close(self.listen_epoll);
+        self.listen_epoll = -1;
+    }
+
+    if (self.shutdown_event != -1) {
+        ::close(self.shutdown_event);
+        self.shutdown_event = -1;
+    }
+
+    if (self.socket != -1) {
+        ::close(self.socket);
+        self.socket = -1;
+    }
+
+    for (int worker_socket : self.worker_sockets) {
+        ::close(worker_socket);
+    }
+    self.worker_sockets.clear();
+}
+
+void Socket::close_client(ClientContext* client_context) {
+    WorkerState& worker = *self.workers[client_context->worker];
+    worker.timers->cancel(client_context->timer);
+    WorkerState::count(worker.disconnections);
+
+    if (self.listeners.on_disconnect) {
+        self.listeners.on_disconnect();
+    }
+    ::close(client_context->socket);
+    ClientPool::destroy(client_context);
+}
+
+void Socket::worker_thread(size_t index) {
+    LOG_TRACE("http::Socket::worker_thread()");
+
+    WorkerState& state = self.start_worker(index);
+    TimerWheel& timers = *state.timers;
+
+    int epoll = self.worker_epolls[index];
+    epoll_event events[64];
+
+    auto expire = [this, &state](Timer& timer) {
+        WorkerState::count(state.timeouts);
+        self.close_client(static_cast<ClientContext*>(timer.data));
+    };
+
+    while (self.ready) {
+        // 타임아웃을 기다리는 연결이 있으면 틱마다 깨어난다
+        int32_t timeout = timers.empty()
+                              ? -1
+                              : static_cast<int32_t>(TIMER_TICK.count());
+        int32_t event_count = epoll_wait(epoll, events, 64, timeout);
+
+        if (event_count == -1) {
+            if (errno == EINTR) {
+                continue;
+            }
+            LOG_ERROR("Failed to wait for events: {}", std::strerror(errno));
+            break;
+        }
+
+        for (int32_t i = 0; i < event_count; ++i) {
+            if (events[i].data.ptr == &self.shutdown_event) {
+                continue;
+            }
+
+            if (events[i].data.ptr == nullptr) {
+                self.accept_clients(self.worker_sockets[index], index);
+                continue;
+            }
+
+            ClientContext* client_context =
+                static_cast<ClientContext*>(events[i].data.ptr);
+            bool closed = (events[i].events & (EPOLLHUP | EPOLLERR)) != 0;
+
+            if (!closed && !client_context->output.empty()) {
+                // 쓸 수 있게 되었으면 밀린 응답부터 보낸다
+                self.flush_output(client_context);
+                while (self.resume_input(client_context)) {
+                }
+            }
+
+            // Edge-triggered 이므로 EAGAIN 이 나올 때까지 모두 읽는다. 멈춘
+            // 동안 남은 데이터는 재개할 때 EPOLLOUT 이벤트에서 읽는다
+            while (!closed && !client_context->paused &&
+                   !client_context->close_after_send) {
+                std::span<char> space =
+                    client_context->input.prepare(BUFFER_SIZE);
+                ssize_t bytes_received = ::recv(
+                    client_context->socket, space.data(), space.size(), 0);
+
+                if (bytes_received == 0) {
+                    closed = true;
+                    break;
+                }
+
+                if (bytes_received < 0) {
+                    if (errno == EINTR) {
+                        continue;
+                    }
+                    if (errno != EAGAIN && errno != EWOULDBLOCK) {
+                        LOG_ERROR("Failed to receive data from client: {}",
+                            std::strerror(errno));
+                        closed = true;
+                    }
+                    break;
+                }
+
+                client_context->input.commit(
+                    static_cast<size_t>(bytes_received));
+                WorkerState::count(self.workers[index]->bytes_received,
+                    static_cast<uint64_t>(bytes_received));
+                if (!self.process_input(client_context)) {
+                    client_context->close_after_send = true;
+                }
+                self.flush_output(client_context);
+                while (self.resume_input(client_context)) {
+                }
+            }
+
+            // 마지막 응답까지 다 보냈으면 닫는다
+            if (client_context->close_after_send &&
+                client_context->output.empty()) {
+                closed = true;
+            }
+
+            if (closed) {
+                self.close_client(client_context);
+            } else {
+                self.update_deadline(client_context);
+            }
+        }
+
+        timers.advance(Socket::current_tick(), expire);
+    }
+
+    // 종료할 때 남은 연결을 닫고 슬랩에 돌려준다
+    state.clients->for_each([this](ClientContext& client_context) {
+        self.close_client(&client_context);
+    });
+    self.workers_stopped->count_down();
+}
+
+SocketStats Socket::stats() const noexcept {
+    SocketStats stats{};
+    stats.connections = self.accepted.load(std::memory_order_relaxed);
+
+    for (const std::unique_ptr<WorkerState>& worker : self.workers) {
+        if (worker == nullptr) {
+            continue;
+        }
+        stats.connections += worker->connections.load(std::memory_order_relaxed);
+        stats.disconnections +=
+            worker->disconnections.load(std::memory_order_relaxed);
+        stats.timeouts += worker->timeouts.load(std::memory_order_relaxed);
+        stats.requests += worker->requests.load(std::memory_order_relaxed);
+        stats.bytes_received +=
+            worker->bytes_received.load(std::memory_order_relaxed);
+        stats.bytes_sent += worker->bytes_sent.load(std::memory_order_relaxed);
+    }
+
+    return stats;
+}
+
+WorkerState& Socket::start_worker(size_t index) {
+    LOG_TRACE("http::Socket::start_worker()");
+
+    int32_t cpu = self.config.pin_threads ? pin_current_thread(index) : -1;
+
+    // 고정된 뒤에 할당해야 first-touch 로 워커의 NUMA 노드에 놓인다
+    std::unique_ptr<WorkerState> state = std::make_unique<WorkerState>();
+    state->index = index;
+    state->cpu = cpu;
+    // 워커 수로 나눠 전체 연결 수가 max_connections 를 넘지 않게 한다
+    state->clients.emplace(
+        self.config.max_connections / self.config.max_threads);
+    state->timers.emplace(Socket::current_tick());
+
+    unsigned int current_cpu = 0;
+    unsigned int current_node = 0;
+    if (cpu >= 0 &&
+        syscall(SYS_getcpu, &current_cpu, &current_node, nullptr) == 0) {
+        state->numa_node = static_cast<int32_t>(current_node);
+
+        if (!self.worker_rings.empty()) {
+            move_to_numa_node(
+                self.worker_rings[index]->buffer_memory(), state->numa_node);
+        }
+    }
+
+    WorkerState& worker = *state;
+    self.workers[index] = std::move(state);
+    self.workers_started->count_down();
+
+    return worker;
+}
+
+bool Socket::receive(ClientContext* client_context, std::span<char> data) {
+    WorkerState::count(
+        self.workers[client_context->worker]->bytes_received, data.size());
+
+    // 오류 응답을 보내는 중이면 남은 입력은 버린다
+    if (client_context->close_after_send) {
+        return true;
+    }
+
+    // 보낼 응답이 남지 않았으면 본문이 아레나를 가리키고 있지 않다
+    if (client_context->output.empty()) {
+        client_context->arena.reset();
+    }
+    Arena::Scope arena_scope(client_context->arena);
+
+    if (!client_context->input.empty() || client_context->paused) {
+        client_context->input.append(std::string_view(data.data(), data.size()));
+        return self.process_input(client_context);
+    }
+
+    // 누적된 데이터가 없으면 복사 없이 받은 버퍼에서 바로 요청을 처리한다
+    while (!data.empty()) {
+        Request request{};
+        ParseResult result = client_context->parser.parse(data, request);
+
+        if (result.status == ParseStatus::Error) {
+            self.reject(client_context, result.error);
+            return false;
+        }
+        if (result.status == ParseStatus::Incomplete) {
+            client_context->input.append(
+                std::string_view(data.data(), data.size()));
+            return true;
+        }
+
+        self.dispatch(client_context, std::move(request));
+        data = data.subspan(result.consumed);
+
+        // 닫기로 한 요청 뒤의 요청은 버린다
+        if (client_context->close_after_send) {
+            return false;
+        }
+
+        // 송신 대기열이 넘치면 나머지는 재개할 때까지 쌓아둔다
+        if (client_context->paused) {
+            client_context->input.append(
+                std::string_view(data.data(), data.size()));
+            return true;
+        }
+    }
+
+    return true;
+}
+
+bool Socket::process_input(ClientContext* client_context) {
+    InputBuffer& input = client_context->input;
+
+    if (client_context->output.empty()) {
+        client_context->arena.reset();
+    }
+    Arena::Scope arena_scope(client_context->arena);
+
+    while (!input.empty() && !client_context->paused) {
+        Request request{};
+        ParseResult result =
+            client_context->parser.parse(input.mutable_data(), request);
+
+        if (result.status == ParseStatus::Error) {
+            self.reject(client_context, result.error);
+            return false;
+        }
+        if (result.status == ParseStatus::Incomplete) {
+            break;
+        }
+
+        self.dispatch(client_context, std::move(request));
+        input.consume(result.consumed);
+
+        if (client_context->close_after_send) {
+            input.consume(input.size());
+            return false;
+        }
+    }
+
+    return true;
+}
+
+/**
+ * Queues the body of `response` behind its head without copying it: the body
+ * or file range, each multipart head followed by its span, or the stream.
+ */
+static void queue_body(OutputQueue& output, Response& response, bool chunked) {
+    if (response.stream.has_value()) {
+        output.append_stream(std::move(response.stream.value()), chunked);
+        response.stream.reset();
+        return;
+    }
+
+    auto queue_span = [&output, &response](uint64_t offset, uint64_t length) {
+        if (response.file.has_value()) {
+            const FileBody& file = response.file.value();
+            output.append_file(
+                FileBody{file.file, file.offset + offset, length});
+        } else if (response.body_owner != nullptr) {
+            output.append_shared(
+                response.body.substr(static_cast<size_t>(offset),
+                    static_cast<size_t>(length)),
+                response.body_owner);
+        } else {
+            output.append_view(response.body.substr(
+                static_cast<size_t>(offset), static_cast<size_t>(length)));
+        }
+    };
+
+    if (response.parts.empty()) {
+        queue_span(0, Response::body_size(response));
+        return;
+    }
+    for (const BodyPart& part : response.parts) {
+        output.append(part.head);
+        queue_span(part.offset, part.length);
+    }
+}
+
+/**
+ * Writes the head straight into a queue block and queues the body behind it
+ * by reference.
+ */
+void ResponseSink::send(Response& response, bool last) {
+    // HTTP/1.0 은 chunked 를 모르므로 연결을 닫아 본문의 끝을 알린다
+    bool chunked = false;
+    if (response.stream.has_value() && !response.stream->length.has_value()) {
+        if (response.http_version == HttpVersion::Http1_0) {
+            self.closing = true;
+            last = true;
+        } else {
+            response.fields["Transfer-Encoding"] = "chunked";
+            chunked = true;
+        }
+    }
+
+    if (last) {
+        set_connection(response, self.closing);
+    }
+
+    size_t head_size = Response::head_size(response);
+    std::span<char> space = self.output.prepare(head_size);
+    Response::write_head(response, space.data());
+    self.output.commit(head_size);
+    queue_body(self.output, response, chunked);
+
+    LOG_TRACE("Sending response: {}{}",
+        std::string_view(space.data(), head_size), response.body);
+}
+
+void Socket::dispatch(ClientContext* client_context, Request&& request) {
+    LOG_TRACE("Received request: {} {}", request.method_to_string(),
+        request.request_target);
+
+    WorkerState::count(self.workers[client_context->worker]->requests);
+
+    ++client_context->requests;
+    if (self.config.max_requests_per_connection != 0 &&
+        client_context->requests >= self.config.max_requests_per_connection) {
+        client_context->close_after_send = true;
+    }
+
+    // Connection: close 나 keep-alive 없는 HTTP/1.0 은 응답 뒤에 닫는다
+    if (!request.keep_alive()) {
+        client_context->close_after_send = true;
+    }
+
+    if (!self.listeners.on_receive) {
+        return;
+    }
+
+    // 같은 수신에서 나온 응답은 요청 순서대로 모았다가 한 번에 보낸다
+    ResponseSink sink(client_context->output, client_context->close_after_send);
+    self.listeners.on_receive.call(
+        self.listeners.on_receive.context, std::move(request), sink);
+
+    // 읽지 않는 클라이언트의 응답이 쌓이지 않도록 수신을 멈춘다
+    if (client_context->output.size() > OUTPUT_HIGH_WATERMARK) {
+        client_context->paused = true;
+    }
+}
+
+void Socket::reject(ClientContext* client_context, ParseError error) {
+    LOG_ERROR("Invalid request ({}), closing connection",
+        parse_error_to_string(error));
+
+    client_context->input.consume(client_context->input.size());
+    client_context->output.append(
+        Response::error_to_message(parse_error_to_http_code(error)));
+}
+
+bool Socket::resume_input(ClientContext* client_context) {
+    if (!client_context->paused ||
+        client_context->output.size() > OUTPUT_LOW_WATERMARK) {
+        return false;
+    }
+
+    // 멈춘 동안 쌓인 요청부터 처리한다
+    client_context->paused = false;
+    if (!self.process_input(client_context)) {
+        client_context->close_after_send = true;
+    }
+    self.flush_output(client_context);
+    return true;
+}
+
+uint64_t Socket::current_tick() noexcept {
+    return static_cast<uint64_t>(
+        std::chrono::steady_clock::now().time_since_epoch() / TIMER_TICK);
+}
+
+void Socket::update_deadline(ClientContext* client_context) {
+    if (client_context->closing) {
+        return;
+    }
+
+    // 수신을 멈춘 동안에는 클라이언트가 응답을 읽기를 기다리는 중이다
+    ConnectionPhase phase = ConnectionPhase::Idle;
+    if (!client_context->input.empty() && !client_context->paused) {
+        phase = client_context->parser.in_body() ? ConnectionPhase::Body
+                                                 : ConnectionPhase::Header;
+    } else if (client_context->requests == 0) {
+        // 첫 요청이 다 오기 전에는 헤더 타임아웃을 적용한다
+        phase = ConnectionPhase::Header;
+    }
+
+    // 유휴 타임아웃은 활동마다 연장하고, 헤더와 본문은 단계가 시작될 때만 건다
+    if (phase != ConnectionPhase::Idle && phase == client_context->phase &&
+        client_context->timer.scheduled()) {
+        return;
+    }
+
+    std::chrono::milliseconds timeout = self.config.idle_timeout;
+    if (phase == ConnectionPhase::Header) {
+        timeout = self.config.header_timeout;
+    } else if (phase == ConnectionPhase::Body) {
+        timeout = self.config.body_timeout;
+    }
+
+    uint64_t ticks = static_cast<uint64_t>(
+        (timeout + TIMER_TICK - std::chrono::milliseconds(1)) / TIMER_TICK);
+
+    client_context->phase = phase;
+    client_context->timer.data = client_context;
+    self.workers[client_context->worker]->timers->schedule(
+        client_context->timer, Socket::current_tick() + ticks);
+}
+
+/**
+ * Sends the start of a queued file range straight from the page cache.
+ * Returns what `sendfile` returns.
+ */
+static ssize_t send_file(int socket, const FileBody& body) noexcept {
+    off_t offset = static_cast<off_t>(body.offset);
+    size_t length =
+        static_cast<size_t>(std::min<uint64_t>(body.length, SENDFILE_MAX_SIZE));
+    return ::sendfile(socket, body.file->descriptor(), &offset, length);
+}
+
+void Socket::flush_output(ClientContext* client_context) {
+    OutputQueue& output = client_context->output;
+
+    if (self.config.engine == IoEngine::IoUring) {
+        if (!client_context->sending) {
+            self.flush_send_queue(client_context);
+        }
+        return;
+    }
+
+    std::array<iovec, SEND_IOVEC_COUNT> iovecs;
+    size_t sent = 0;
+
+    while (!output.empty()) {
+        // 스트림이 길이보다 일찍 끝나면 Content-Length 를 지킬 수 없다
+        if (output.failed()) {
+            LOG_ERROR("Stream body failed, closing connection");
+            output.clear();
+            ::shutdown(client_context->socket, SHUT_RDWR);
+            break;
+        }
+
+        ssize_t result = 0;
+        const FileBody* file = output.front_file();
+
+        if (file != nullptr) {
+            result = send_file(client_context->socket, *file);
+        } else {
+            msghdr message{};
+            message.msg_iov = iovecs.data();
+            message.msg_iovlen = output.gather(iovecs);
+            result = ::sendmsg(client_context->socket, &message, MSG_NOSIGNAL);
+        }
+
+        // 보내는 도중 파일이 줄어들면 Content-Length 를 지킬 수 없다
+        if (result == 0 && file != nullptr) {
+            LOG_ERROR("File was truncated while sending, closing connection");
+            output.clear();
+            ::shutdown(client_context->socket, SHUT_RDWR);
+            break;
+        }
+
+        if (result >= 0) {
+            output.consume(static_cast<size_t>(result));
+            sent += static_cast<size_t>(result);
+            continue;
+        }
+
+        if (errno == EINTR) {
+            continue;
+        }
+
+        if (errno == EAGAIN || errno == EWOULDBLOCK) {
+            // 송신 버퍼가 가득 찼으면 남은 부분은 EPOLLOUT 에서 이어 보낸다
+            break;
+        }
+
+        LOG_ERROR("Failed to send data to client: {}", std::strerror(errno));
+        output.clear();
+        ::shutdown(client_context->socket, SHUT_RDWR);
+        break;
+    }
+
+    WorkerState::count(
+        self.workers[client_context->worker]->bytes_sent, sent);
+}
+
+// ClientContext 는 64 바이트 정렬이므로 user_data 하위 3비트에 작업 종류를 담는다
+enum struct IoUringOperation : uint64_t {
+    Accept = 0,
+    Receive = 1,
+    Send = 2,
+    Shutdown = 3,
+    Timeout = 4,
+    Cancel = 5,
+    Writable = 6,
+};
+static constexpr uint64_t IO_URING_OPERATION_MASK = 7;
+
+static uint64_t io_uring_user_data(
+    ClientContext* client_context, IoUringOperation operation) noexcept {
+    return reinterpret_cast<uint64_t>(client_context) |
+           static_cast<uint64_t>(operation);
+}
+
+void Socket::flush_send_queue(ClientContext* client_context) {
+    OutputQueue& output = client_context->output;
+    IoUring& ring = *self.worker_rings[client_context->worker];
+
+    if (output.failed()) {
+        LOG_ERROR("Stream body failed, closing connection");
+        output.clear();
+        client_context->sending = false;
+        client_context->close_after_send = true;
+        ::shutdown(client_context->socket, SHUT_RDWR);
+        return;
+    }
+
+    // io_uring 에는 sendfile 이 없으므로 파일 구간은 워커에서 바로 보내고,
+    // 소켓이 가득 차면 쓸 수 있게 될 때 이어서 보낸다
+    while (!client_context->closing && output.front_file() != nullptr) {
+        ssize_t result =
+            send_file(client_context->socket, *output.front_file());
+
+        if (result > 0) {
+            output.consume(static_cast<size_t>(result));
+            WorkerState::count(self.workers[client_context->worker]->bytes_sent,
+                static_cast<uint64_t>(result));
+            continue;
+        }
+        if (result < 0 && errno == EINTR) {
+            continue;
+        }
+        if (result < 0 && (errno == EAGAIN || errno == EWOULDBLOCK)) {
+            client_context->sending = ring.prep_poll(client_context->socket,
+                POLLOUT,
+                io_uring_user_data(client_context, IoUringOperation::Writable));
+            if (client_context->sending) {
+                return;
+            }
+            LOG_ERROR("io_uring submission queue is full, dropping client");
+        } else {
+            LOG_ERROR("Failed to send file to client: {}",
+                result == 0 ? "file truncated" : std::strerror(errno));
+        }
+
+        output.clear();
+        client_context->sending = false;
+        client_context->close_after_send = true;
+        ::shutdown(client_context->socket, SHUT_RDWR);
+        return;
+    }
+
+    if (output.empty() || client_context->closing) {
+        client_context->sending = false;
+        return;
+    }
+
+    // msghdr 와 iovec 은 완료될 때까지 ClientContext 안에 둔다
+    msghdr& message = client_context->send_message;
+    message = msghdr{};
+    message.msg_iov = client_context->send_iovecs.data();
+    message.msg_iovlen = output.gather(client_context->send_iovecs);
+
+    client_context->sending = ring.prep_sendmsg(client_context->socket,
+        &message, io_uring_user_data(client_context, IoUringOperation::Send));
+
+    if (!client_context->sending) {
+        LOG_ERROR("io_uring submission queue is full, dropping client");
+        output.clear();
+        client_context->close_after_send = true;
+        ::shutdown(client_context->socket, SHUT_RDWR);
+    }
+}
+
+void Socket::io_uring_worker_thread(size_t index) {
+    LOG_TRACE("http::Socket::io_uring_worker_thread()");
+
+    WorkerState& state = self.start_worker(index);
+
+    IoUring& ring = *self.worker_rings[index];
+    int listen_socket =
+        self.config.reuse_port ? self.worker_sockets[index] : self.socket;
+
+    ring.prep_multishot_accept(
+        listen_socket, io_uring_user_data(nullptr, IoUringOperation::Accept));
+    ring.prep_poll(self.shutdown_event, POLLIN,
+        io_uring_user_data(nullptr, IoUringOperation::Shutdown));
+
+    TimerWheel& timers = *state.timers;
+    // 타임아웃을 기다리는 연결이 있는 동안 틱마다 완료되는 타이머를 건다
+    __kernel_timespec tick{.tv_sec = 0,
+        .tv_nsec = std::chrono::nanoseconds(TIMER_TICK).count()};
+    bool ticking = false;
+
+    auto disconnect = [this, &state, &timers](ClientContext* client_context) {
+        if (!client_context->closing) {
+            timers.cancel(client_context->timer);
+            client_context->closing = true;
+            ::shutdown(client_context->socket, SHUT_RDWR);
+            WorkerState::count(state.disconnections);
+            if (self.listeners.on_disconnect) {
+                self.listeners.on_disconnect();
+            }
+        }
+    };
+
+    // 양쪽 작업이 모두 끝난 연결만 해제한다
+    auto release = [this](ClientContext* client_context) {
+        if (client_context->closing && !client_context->receiving &&
+            !client_context->sending) {
+            ::close(client_context->socket);
+            ClientPool::destroy(client_context);
+        }
+    };
+
+    auto expire = [&state, &disconnect](Timer& timer) {
+        WorkerState::count(state.timeouts);
+        disconnect(static_cast<ClientContext*>(timer.data));
+    };
+
+    while (self.ready) {
+        timers.advance(Socket::current_tick(), expire);
+        if (!ticking && !timers.empty()) {
+            ticking = ring.prep_timeout(
+                &tick, io_uring_user_data(nullptr, IoUringOperation::Timeout));
+        }
+
+        // 쌓인 SQE 를 한 번에 제출하고 최소 하나의 완료를 기다린다
+        int32_t submit_result = ring.submit(1);
+
+        if (submit_result < 0 && submit_result != -EINTR &&
+            submit_result != -EBUSY) {
+            LOG_ERROR("Failed to submit to io_uring: {}",
+                std::strerror(-submit_result));
+            break;
+        }
+
+        ring.for_each_cqe([&](const io_uring_cqe& cqe) {
+            IoUringOperation operation = static_cast<IoUringOperation>(
+                cqe.user_data & IO_URING_OPERATION_MASK);
+            ClientContext* client_context = reinterpret_cast<ClientContext*>(
+                cqe.user_data & ~IO_URING_OPERATION_MASK);
+
+            switch (operation) {
+                case IoUringOperation::Accept: {
+                    if (cqe.res >= 0) {
+                        int32_t no_delay = 1;
+                        setsockopt(cqe.res, IPPROTO_TCP, TCP_NODELAY,
+                            &no_delay, sizeof(no_delay));
+
+                        ClientContext* client = state.clients->create();
+
+                        if (client == nullptr) {
+                            LOG_WARN("Connection limit reached, closing new "
+                                     "connection");
+                            ::close(cqe.res);
+                        } else {
+                            client->socket = cqe.res;
+                            client->worker = index;
+                            client->receiving = ring.prep_multishot_recv(
+                                client->socket, 0,
+                                io_uring_user_data(
+                                    client, IoUringOperation::Receive));
+
+                            if (!client->receiving) {
+                                ::close(client->socket);
+                                ClientPool::destroy(client);
+                            } else {
+                                WorkerState::count(state.connections);
+                                self.update_deadline(client);
+                                if (self.listeners.on_connect) {
+                                    self.listeners.on_connect();
+                                }
+                            }
+                        }
+                    } else if (cqe.res != -EINTR &&
+                               cqe.res != -ECONNABORTED) {
+                        LOG_ERROR("Failed to accept connection: {}",
+                            std::strerror(-cqe.res));
+                    }
+
+                    if (!(cqe.flags & IORING_CQE_F_MORE) && self.ready) {
+                        ring.prep_multishot_accept(listen_socket,
+                            io_uring_user_data(
+                                nullptr, IoUringOperation::Accept));
+                    }
+                    break;
+                }
+                case IoUringOperation::Receive: {
+                    if (cqe.flags & IORING_CQE_F_BUFFER) {
+                        uint16_t buffer_id = static_cast<uint16_t>(
+                            cqe.flags >> IORING_CQE_BUFFER_SHIFT);
+
+                        if (cqe.res > 0 && !client_context->closing) {
+                            bool was_paused = client_context->paused;
+                            bool valid = self.receive(client_context,
+                                std::span<char>(ring.buffer(buffer_id),
+                                    static_cast<size_t>(cqe.res)));
+                            self.flush_output(client_context);
+
+                            // 오류 응답이 나갈 때까지 종료를 미룬다
+                            if (!valid) {
+                                client_context->close_after_send = true;
+                            }
+                            if (client_context->close_after_send &&
+                                !client_context->sending) {
+                                disconnect(client_context);
+                            }
+                            // 수신을 멈추면 multishot recv 를 취소한다
+                            if (!was_paused && client_context->paused &&
+                                !client_context->closing) {
+                                ring.prep_cancel(
+                                    io_uring_user_data(client_context,
+                                        IoUringOperation::Receive),
+                                    io_uring_user_data(
+                                        nullptr, IoUringOperation::Cancel));
+                            }
+                            self.update_deadline(client_context);
+                        }
+                        ring.recycle_buffer(buffer_id);
+                    }
+
+                    if (cqe.flags & IORING_CQE_F_MORE) {
+                        break;
+                    }
+
+                    // 멈춘 동안에는 recv 를 다시 걸지 않고 송신 완료에서 재개한다
+                    if (client_context->paused && cqe.res != 0 &&
+                        !client_context->closing) {
+                        client_context->receiving = false;
+                        break;
+                    }
+
+                    // 버퍼가 바닥났거나 multishot 이 끝났으면 다시 건다
+                    // 멈춘 사이 재개되었으면 취소된 recv 도 다시 건다
+                    if ((cqe.res > 0 || cqe.res == -ENOBUFS ||
+                            cqe.res == -ECANCELED) &&
+                        !client_context->closing) {
+                        client_context->receiving = ring.prep_multishot_recv(
+                            client_context->socket, 0,
+                            io_uring_user_data(
+                                client_context, IoUringOperation::Receive));
+                        if (client_context->receiving) {
+                            break;
+                        }
+                    }
+
+                    client_context->receiving = false;
+                    disconnect(client_context);
+                    release(client_context);
+                    break;
+                }
+                case IoUringOperation::Send:
+                case IoUringOperation::Writable: {
+                    if (cqe.res < 0) {
+                        LOG_ERROR("Failed to send data to client: {}",
+                            std::strerror(-cqe.res));
+                        client_context->output.clear();
+                        client_context->sending = false;
+                        disconnect(client_context);
+                        release(client_context);
+                        break;
+                    }
+
+                    // 부분 송신이면 남은 부분부터 이어서 보낸다. Writable 은
+                    // 파일을 보내던 소켓이 다시 쓸 수 있게 된 것이다
+                    if (operation == IoUringOperation::Send) {
+                        WorkerState::count(
+                            state.bytes_sent, static_cast<uint64_t>(cqe.res));
+                        client_context->output.consume(
+                            static_cast<size_t>(cqe.res));
+                    }
+
+                    self.flush_send_queue(client_context);
+
+                    // 대기열이 줄었으면 쌓인 요청을 처리하고 수신을 다시 건다
+                    if (!client_context->closing &&
+                        self.resume_input(client_context)) {
+                        if (!client_context->paused &&
+                            !client_context->receiving &&
+                            !client_context->close_after_send) {
+                            client_context->receiving =
+                                ring.prep_multishot_recv(client_context->socket,
+                                    0,
+                                    io_uring_user_data(client_context,
+                                        IoUringOperation::Receive));
+                            if (!client_context->receiving) {
+                                disconnect(client_context);
+                            }
+                        }
+                    }
+
+                    if (client_context->close_after_send &&
+                        !client_context->sending) {
+                        disconnect(client_context);
+                    }
+                    self.update_deadline(client_context);
+                    release(client_context);
+                    break;
+                }
+                case IoUringOperation::Timeout:
+                    ticking = false;
+                    break;
+                case IoUringOperation::Cancel:
+                    break;
+                case IoUringOperation::Shutdown:
+                    break;
+            }
+        });
+    }
+
+    // 종료할 때 남은 연결을 닫고 슬랩에 돌려준다. 진행 중인 작업은 소켓을
+    // 끊어 실패하게 한다
+    state.clients->for_each([&disconnect](ClientContext& client_context) {
+        disconnect(&client_context);
+        ::close(client_context.socket);
+        ClientPool::destroy(&client_context);
+    });
+    self.workers_stopped->count_down();
+}
 #endif
 
 }  // namespace http
\ No newline at end of file
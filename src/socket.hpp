@@ -1,15 +1,23 @@
 #pragma once
 
+#include <atomic>
+#include <chrono>
 #include <coroutine>
 #include <cstddef>
 #include <cstdint>
 #include <format>
 #include <functional>
+#include <latch>
 #include <optional>
 #include <stdexcept>
 #include <string>
 #include <string_view>
 #include <thread>
+#include "arena.hpp"
+#include "buffer_pool.hpp"
+#include "input_buffer.hpp"
+#include "request_parser.hpp"
+#include "slab_pool.hpp"
 
 #ifdef _WIN32
     #ifndef WIN32_LEAN_AND_MEAN
@@ -22,33 +30,125 @@
     #include <ws2tcpip.h>
 
     #pragma comment(lib, "Ws2_32.lib")
+#else
+    #include <array>
+    #include <cerrno>
+    #include <cstring>
+    #include <memory>
+    #include <vector>
+
+    #include <fcntl.h>
+    #include <linux/filter.h>
+    #include <linux/mempolicy.h>
+    #include <netdb.h>
+    #include <netinet/in.h>
+    #include <netinet/tcp.h>
+    #include <poll.h>
+    #include <pthread.h>
+    #include <sched.h>
+    #include <sys/epoll.h>
+    #include <sys/eventfd.h>
+    #include <sys/sendfile.h>
+    #include <sys/socket.h>
+    #include <sys/syscall.h>
+    #include <unistd.h>
+
+    #include "io_uring.hpp"
+    #include "output_queue.hpp"
+    #include "timer_wheel.hpp"
 #endif
 
 namespace http {
 
 static constexpr size_t BUFFER_SIZE = 4096;
+static constexpr uint32_t IO_URING_ENTRIES = 4096;
+static constexpr uint16_t IO_URING_BUFFER_COUNT = 1024;
+static constexpr size_t SEND_IOVEC_COUNT = 32;
+static constexpr std::chrono::milliseconds TIMER_TICK{100};
+// 보내지 못한 응답이 HIGH 를 넘으면 수신을 멈추고 LOW 이하가 되면 재개한다
+static constexpr size_t OUTPUT_HIGH_WATERMARK = 1024 * 1024;
+static constexpr size_t OUTPUT_LOW_WATERMARK = 256 * 1024;
+#ifndef _WIN32
+// sendfile 한 번에 보낼 수 있는 최대 크기
+static constexpr size_t SENDFILE_MAX_SIZE = 0x7ffff000;
+#endif
 
 class Response;
+struct Request;
+class ResponseSink;
 
-#ifdef _WIN32
-struct ClientContext {
-    OVERLAPPED overlapped;     // Overlapped 구조체
-    WSABUF wsabuf;             // WSA 버퍼
-    char buffer[BUFFER_SIZE];  // 데이터 버퍼
-    SOCKET socket;             // 클라이언트 소켓
+/**
+ * Request callback of the socket. A plain function pointer and its context
+ * rather than a `std::function`, so a request costs one indirect call into
+ * code the server instantiated for its handler.
+ */
+struct ReceiveHandler {
+    void* context = nullptr;
+    void (*call)(void* context, Request&& request, ResponseSink& sink) =
+        nullptr;
+
+    explicit operator bool() const noexcept {
+        return call != nullptr;
+    }
 };
 
+// Windows 에서는 항상 IOCP 를 사용하므로 무시된다
+enum struct IoEngine { Epoll, IoUring };
+
 struct SocketConfig {
     uint16_t port = 3000;
     size_t max_threads = 8;
+    IoEngine engine = IoEngine::Epoll;
+    bool reuse_port = false;       // 워커별 SO_REUSEPORT 리스너 (Linux)
+    bool pin_threads = false;      // 워커를 CPU 에 고정
+    bool thread_per_core = false;  // 코어당 워커 하나, 상태 공유 없음
+    size_t max_connections = 65536;  // 동시 연결 상한, 연결 객체 메모리의 상한
+
+    // 연결 타임아웃 (Linux). 헤더와 본문은 시작부터 끝까지 걸리는 시간이다
+    std::chrono::milliseconds idle_timeout = std::chrono::seconds(60);
+    std::chrono::milliseconds header_timeout = std::chrono::seconds(10);
+    std::chrono::milliseconds body_timeout = std::chrono::seconds(60);
+    size_t max_requests_per_connection = 1000;  // 0 이면 제한 없음
 };
+
+#ifdef _WIN32
+struct ClientContext {
+    OVERLAPPED overlapped;     // 수신용 Overlapped 구조체
+    WSABUF wsabuf;          // WSA 버퍼
+    SOCKET socket;          // 클라이언트 소켓
+    InputBuffer input;      // 수신 버퍼, 완성되지 않은 요청을 누적한다
+    RequestParser parser;   // 요청 파싱 상태
+    std::string output;     // 이번 수신에서 만든 응답 묶음
+    Arena arena;            // 요청을 처리하며 쓰는 메모리, 수신마다 비운다
+    // 진행 중인 수신 1 + 송신 수, 0 이 되면 해제한다
+    std::atomic<uint32_t> references = 1;
+    std::atomic<size_t> unsent = 0;     // 완료되지 않은 송신 바이트 수
+    std::atomic<bool> paused = false;   // 송신이 밀려 수신을 걸지 않음
+};
+
+using ClientPool = SlabPool<ClientContext>;
+
+/**
+ * One overlapped `WSASend`. It sits at the front of a `BufferPool` buffer
+ * with the bytes to send right behind it, and lives until its completion is
+ * dequeued, so the kernel never reads freed memory and sends never share
+ * the receive's OVERLAPPED.
+ */
+struct SendContext {
+    OVERLAPPED overlapped;
+    WSABUF wsabuf;
+    ClientContext* client_context;
+};
+
+static constexpr size_t SEND_BUFFER_CAPACITY =
+    POOL_BUFFER_SIZE - sizeof(SendContext);
+
 class Socket {
 public:
     struct Listener {
         std::function<void()> on_connect;
         std::function<void()> on_disconnect;
-        std::function<std::optional<std::vector<Response>>(std::string_view)>
-            on_receive;
+        ReceiveHandler on_receive;
     };
 
 public:
@@ -74,12 +174,14 @@ public:
 
     void on_connect(std::function<void()> func);
     void on_disconnect(std::function<void()> func);
-    void on_receive(
-        std::function<std::optional<std::vector<Response>>(std::string_view)>
-            func);
+    void on_receive(ReceiveHandler func);
 
 private:
     void worker_thread();
+    void complete_send(SendContext* send_context, DWORD bytes_sent,
+        bool succeeded);
+    void post_receive(ClientContext* client_context);
+    void release_client(ClientContext* client_context);
 
 private:
     Socket& self = *this;
@@ -88,16 +190,204 @@ private:
     SOCKET socket = INVALID_SOCKET;
     std::vector<std::jthread> worker_threads;
     HANDLE iocp;
+    std::optional<ClientPool> clients;  // accept 스레드가 소유한다
     Listener listeners{};
     bool ready = false;
 };
-#elif
+#else
+struct SocketStats {
+    uint64_t connections = 0;
+    uint64_t disconnections = 0;
+    uint64_t timeouts = 0;
+    uint64_t requests = 0;
+    uint64_t bytes_received = 0;
+    uint64_t bytes_sent = 0;
+};
+
+// 연결이 어떤 타임아웃을 기다리는지
+enum struct ConnectionPhase : uint8_t { Idle, Header, Body };
+
+/**
+ * Per-connection state, recycled through the worker's `ClientPool`. Fields
+ * touched on every event share the first cache line; the buffers and the
+ * parser start on their own lines so I/O on them does not evict it.
+ */
+struct alignas(64) ClientContext {
+    int socket;                          // 클라이언트 소켓
+    size_t worker;                       // 소켓을 소유한 워커 인덱스
+    Timer timer;                         // 현재 단계의 타임아웃
+    uint32_t requests = 0;               // 이 연결에서 처리한 요청 수
+    ConnectionPhase phase = ConnectionPhase::Header;
+    bool receiving = false;              // multishot recv 진행 중
+    bool sending = false;                // send 진행 중
+    bool closing = false;                // 연결 종료 중
+    bool close_after_send = false;       // 마지막 응답 송신 후 종료
+    bool paused = false;                 // 송신 대기열이 넘쳐 수신을 멈춤
+
+    alignas(64) InputBuffer input;       // 완성되지 않은 요청 누적 버퍼
+    RequestParser parser;                // 요청 파싱 상태
+    alignas(64) OutputQueue output;      // 응답 송신 대기열
+    Arena arena;  // 요청을 처리하며 쓰는 메모리, 대기열이 비면 비운다
+    msghdr send_message{};               // 진행 중인 sendmsg (io_uring)
+    std::array<iovec, SEND_IOVEC_COUNT> send_iovecs{};
+};
+
+using ClientPool = SlabPool<ClientContext>;
+
+/**
+ * Everything a worker owns. Allocated by the worker thread after pinning, so
+ * first-touch places it on the worker's NUMA node, and written only by that
+ * thread. Counters are atomics only so `Socket::stats()` can read them.
+ */
+struct alignas(64) WorkerState {
+    size_t index = 0;
+    int32_t cpu = -1;
+    int32_t numa_node = -1;
+
+    std::atomic<uint64_t> connections = 0;
+    std::atomic<uint64_t> disconnections = 0;
+    std::atomic<uint64_t> timeouts = 0;
+    std::atomic<uint64_t> requests = 0;
+    std::atomic<uint64_t> bytes_received = 0;
+    std::atomic<uint64_t> bytes_sent = 0;
+
+    std::optional<ClientPool> clients;  // 이 워커가 accept 한 연결
+    std::optional<TimerWheel> timers;   // 이 워커가 처리하는 연결의 타임아웃
+
+    // 단일 작성자이므로 lock 없는 load + store 로 충분하다
+    static void count(std::atomic<uint64_t>& counter, uint64_t value = 1) noexcept {
+        counter.store(counter.load(std::memory_order_relaxed) + value,
+            std::memory_order_relaxed);
+    }
+};
+
+/**
+ * Linux backend with two engines.
+ *
+ * `IoEngine::Epoll`: the listen socket is accepted on the calling thread and
+ * every client is handed to one of `max_threads` workers, each owning its own
+ * edge-triggered epoll instance. With `reuse_port` every worker instead opens
+ * its own SO_REUSEPORT listener and accepts in its own loop.
+ *
+ * `thread_per_core` starts one pinned worker per allowed CPU with its own
+ * listener, so a connection and all of its state stay on a single core.
+ *
+ * `IoEngine::IoUring`: every worker owns an io_uring with a multishot accept
+ * on the listen socket, multishot recv into a provided buffer ring for each
+ * client, and submits all queued SQEs in one `io_uring_enter` per loop.
+ *
+ * Each worker keeps its connections' idle, header and body deadlines in a
+ * `TimerWheel` and wakes every `TIMER_TICK` while any are pending; expired
+ * connections are closed without scanning the rest.
+ */
 class Socket {
 public:
-    Socket() {
-        std::println("Not implemented");
-    }
-}
+    struct Listener {
+        std::function<void()> on_connect;
+        std::function<void()> on_disconnect;
+        ReceiveHandler on_receive;
+    };
+
+public:
+    Socket() noexcept;
+    Socket(SocketConfig config) noexcept;
+    Socket(SocketConfig&& config) noexcept;
+    Socket(Socket&& other) noexcept;
+    Socket& operator=(Socket&& other);
+
+    Socket(Socket&) = delete;
+    Socket& operator=(Socket&) = delete;
+
+    ~Socket();
+
+    void init();
+    void listen();
+    void terminate();
+    void send(ClientContext* client_context, std::string_view message);
+
+    void on_connect(std::function<void()> func);
+    void on_disconnect(std::function<void()> func);
+    void on_receive(ReceiveHandler func);
+
+    SocketStats stats() const noexcept;
+
+private:
+    WorkerState& start_worker(size_t index);
+    void worker_thread(size_t index);
+    void io_uring_worker_thread(size_t index);
+    int create_listen_socket();
+    void accept_clients(int listen_socket, std::optional<size_t> worker);
+    void close_client(ClientContext* client_context);
+    bool receive(ClientContext* client_context, std::span<char> data);
+    bool process_input(ClientContext* client_context);
+    void dispatch(ClientContext* client_context, Request&& request);
+    void reject(ClientContext* client_context, ParseError error);
+    void flush_output(ClientContext* client_context);
+    void flush_send_queue(ClientContext* client_context);
+    bool resume_input(ClientContext* client_context);
+    void update_deadline(ClientContext* client_context);
+    static uint64_t current_tick() noexcept;
+
+private:
+    Socket& self = *this;
+
+    SocketConfig config;
+    int socket = -1;
+    std::vector<int> worker_sockets;
+    int listen_epoll = -1;
+    int shutdown_event = -1;
+    std::vector<int> worker_epolls;
+    std::vector<std::unique_ptr<IoUring>> worker_rings;
+    std::vector<std::unique_ptr<WorkerState>> workers;
+    std::unique_ptr<std::latch> workers_started;
+    std::unique_ptr<std::latch> workers_stopped;
+    std::vector<std::jthread> worker_threads;
+    size_t next_worker = 0;
+    std::optional<ClientPool> accepted_clients;  // 리스너 스레드가 accept 한 연결
+    std::atomic<uint64_t> accepted = 0;
+    Listener listeners{};
+    std::atomic<bool> ready = false;
+};
+#endif
+
+/**
+ * Where the server puts the responses to one request. They go straight into
+ * the connection's pending output in request order, heads written in place
+ * and bodies by reference where the platform allows.
+ */
+class ResponseSink {
+public:
+    ResponseSink(ResponseSink&) = delete;
+    ResponseSink& operator=(ResponseSink&) = delete;
+
+    /**
+     * Queues `response`. The `last` response to a request gets
+     * `Connection: close` when the connection closes after it. A stream of
+     * unknown length goes out chunked, or to an HTTP/1.0 client as is,
+     * closing the connection after it.
+     */
+    void send(Response& response, bool last = true);
+
+private:
+    friend class Socket;
+
+#ifdef _WIN32
+    ResponseSink(std::string& output, bool& closing) noexcept
+        : output(output), closing(closing) {}
+#else
+    ResponseSink(OutputQueue& output, bool& closing) noexcept
+        : output(output), closing(closing) {}
+#endif
+
+private:
+    ResponseSink& self = *this;
+
+#ifdef _WIN32
+    std::string& output;  // 이번 수신에서 만든 응답 묶음
+#else
+    OutputQueue& output;
 #endif
+    bool& closing;  // 이 요청의 응답 뒤에 연결을 닫는다
+};
 
 }  // namespace http
@@ -0,0 +1,141 @@
+#include "static_files.hpp"
+#include <array>
+#include "compression.hpp"
+#include "conditional.hpp"
+#include "hash.hpp"
+#include "http_date.hpp"
+#include "log.hpp"
+#include "request_parser.hpp"
+#include "server.hpp"
+
+namespace http {
+
+StaticFiles::StaticFiles(std::filesystem::path root) : root(std::move(root)) {
+    LOG_TRACE("http::StaticFiles()");
+}
+
+std::optional<Response> StaticFiles::serve(
+    const Server& server, const Request& request) const {
+    LOG_TRACE("http::StaticFiles::serve()");
+
+    if (request.method != Method::Get && request.method != Method::Head) {
+        return std::nullopt;
+    }
+
+    std::optional<std::string> relative =
+        StaticFiles::resolve_route(request.route);
+    if (!relative.has_value()) {
+        return std::nullopt;
+    }
+
+    std::filesystem::path path = self.root / relative.value();
+    std::shared_ptr<const File> file = File::open(path);
+
+    if (file == nullptr) {
+        std::error_code error;
+        if (!std::filesystem::is_directory(path, error)) {
+            return std::nullopt;
+        }
+        path /= "index.html";
+        file = File::open(path);
+        if (file == nullptr) {
+            return std::nullopt;
+        }
+    }
+
+    std::string extension = path.extension().string();
+    ContentType content_type = content_type_from_extension(
+        std::string_view(extension).substr(extension.empty() ? 0 : 1));
+
+    // 미리 압축해 둔 .gz 파일이 있으면 gzip 을 받는 클라이언트에게 보낸다
+    bool precompressed = false;
+    std::optional<std::string_view> accept_encoding =
+        request.fields.find(FieldId::AcceptEncoding);
+    if (accept_encoding.has_value() &&
+        accepts_encoding(accept_encoding.value(), ContentEncoding::Gzip)) {
+        std::filesystem::path compressed_path = path;
+        compressed_path += ".gz";
+        std::shared_ptr<const File> compressed = File::open(compressed_path);
+        if (compressed != nullptr) {
+            file = std::move(compressed);
+            path = std::move(compressed_path);
+            precompressed = true;
+        }
+    }
+
+    uint64_t size = file->size();
+    std::string last_modified = format_http_date(file->modified());
+    uint64_t etag_hash = StaticFiles::file_etag_hash(*file);
+
+    Response response = Response::create_file(server, request, HttpCode::Ok,
+        content_type, FileBody{std::move(file), 0, size});
+    response.fields.insert({"Last-Modified", std::move(last_modified)});
+    response.fields.insert({"ETag", EtagText{}.format(etag_hash)});
+    if (precompressed) {
+        response.fields.insert({"Content-Encoding", "gzip"});
+        response.fields.insert({"Vary", "Accept-Encoding"});
+    }
+
+    return std::optional(std::move(response));
+}
+
+std::optional<std::string> StaticFiles::resolve_route(std::string_view route) {
+    LOG_TRACE("http::StaticFiles::resolve_route()");
+
+    if (route.empty() || route.front() != '/') {
+        return std::nullopt;
+    }
+
+    std::string decoded;
+    decoded.reserve(route.size());
+    for (size_t i = 0; i < route.size(); ++i) {
+        char c = route[i];
+        if (c == '%') {
+            if (i + 2 >= route.size()) {
+                return std::nullopt;
+            }
+            int32_t high = detail::hex_value(route[i + 1]);
+            int32_t low = detail::hex_value(route[i + 2]);
+            if (high < 0 || low < 0) {
+                return std::nullopt;
+            }
+            c = static_cast<char>(high * 16 + low);
+            i += 2;
+        }
+
+        // 디코딩된 NUL 과 역슬래시로 경로를 바꿀 수 없게 한다
+        if (c == '\0' || c == '\\') {
+            return std::nullopt;
+        }
+        decoded.push_back(c);
+    }
+
+    // 빈 조각과 "." 은 건너뛰고 ".." 이 있으면 거부한다
+    std::string relative;
+    relative.reserve(decoded.size());
+    for (std::string_view segment : split(decoded, '/')) {
+        if (segment.empty() || segment == ".") {
+            continue;
+        }
+        if (segment == "..") {
+            return std::nullopt;
+        }
+        if (!relative.empty()) {
+            relative.push_back('/');
+        }
+        relative += segment;
+    }
+
+    return std::optional(std::move(relative));
+}
+
+uint64_t StaticFiles::file_etag_hash(const File& file) noexcept {
+    LOG_TRACE("http::StaticFiles::file_etag_hash()");
+
+    std::array<uint64_t, 3> identity{file.size(),
+        static_cast<uint64_t>(file.modified_nanoseconds()), file.inode()};
+    return hash_bytes(std::string_view(
+        reinterpret_cast<const char*>(identity.data()), sizeof(identity)));
+}
+
+}  // namespace http
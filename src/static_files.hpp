@@ -0,0 +1,54 @@
+#pragma once
+#include <filesystem>
+#include <optional>
+#include <string>
+#include <string_view>
+#include "request.hpp"
+#include "response.hpp"
+
+namespace http {
+
+class Server;
+
+/**
+ * Serves GET and HEAD requests from a document root. The body is queued as a
+ * `FileBody`, so only the head is built in memory and the file goes from the
+ * page cache to the socket. Every response carries `Last-Modified` and a
+ * strong `ETag` hashed from the file's size, modification time and inode. A client that accepts gzip
+ * gets a precompressed `.gz` sibling of the file when there is one.
+ */
+class StaticFiles {
+public:
+    explicit StaticFiles(std::filesystem::path root);
+
+    StaticFiles(StaticFiles&) = delete;
+    StaticFiles& operator=(StaticFiles&) = delete;
+
+    /**
+     * Builds the response when the route names a file under the root, or a
+     * directory with an index.html; otherwise the request is left to the
+     * handler.
+     */
+    std::optional<Response> serve(
+        const Server& server, const Request& request) const;
+
+    /**
+     * Percent-decodes `route` and returns it relative to the root, or nullopt
+     * when it could escape the root.
+     */
+    static std::optional<std::string> resolve_route(std::string_view route);
+
+    /**
+     * Hash behind the ETag of `file`, from what `fstat` already returned, so
+     * the request never waits on reading the file. It changes whenever the
+     * file is replaced or modified.
+     */
+    static uint64_t file_etag_hash(const File& file) noexcept;
+
+private:
+    StaticFiles& self = *this;
+
+    std::filesystem::path root;
+};
+
+}  // namespace http
@@ -3,6 +3,7 @@
 #include <ranges>
 #include <string>
 #include <string_view>
+#include "log.hpp"
 
 namespace http {
 
@@ -20,6 +21,36 @@ auto split(std::string_view str, std::string_view delimiter) noexcept {
                [](const auto& i) { return std::string_view(i); });
 }
 
+constexpr char ascii_lowercase(char c) noexcept {
+    return (c >= 'A' && c <= 'Z') ? static_cast<char>(c + ('a' - 'A')) : c;
+}
+
+/**
+ * ASCII case-insensitive comparison, as HTTP field names require.
+ */
+constexpr bool iequals(std::string_view a, std::string_view b) noexcept {
+    if (a.size() != b.size()) {
+        return false;
+    }
+
+    for (size_t i = 0; i < a.size(); ++i) {
+        if (ascii_lowercase(a[i]) != ascii_lowercase(b[i])) {
+            return false;
+        }
+    }
+
+    return true;
+}
+
+constexpr std::string_view trim(std::string_view str) noexcept {
+    size_t begin = str.find_first_not_of(" \t");
+    if (begin == std::string_view::npos) {
+        return {};
+    }
+    size_t end = str.find_last_not_of(" \t");
+    return str.substr(begin, end - begin + 1);
+}
+
 std::string join(
     const std::vector<std::string>& parts, const char* delimiter) noexcept {
     if (parts.size() == 0) {
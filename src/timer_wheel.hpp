@@ -0,0 +1,167 @@
+#pragma once
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include "log.hpp"
+
+namespace http {
+
+static constexpr size_t TIMER_WHEEL_BITS = 6;
+static constexpr size_t TIMER_WHEEL_SLOTS = 1 << TIMER_WHEEL_BITS;
+static constexpr size_t TIMER_WHEEL_LEVELS = 4;
+// 가장 먼 만료 시각, 넘으면 여기에 맞춘다
+static constexpr uint64_t TIMER_WHEEL_RANGE =
+    uint64_t{1} << (TIMER_WHEEL_BITS * TIMER_WHEEL_LEVELS);
+
+/**
+ * Intrusive timer node, embedded in the object it times out. `data` is handed
+ * back to the expiry callback.
+ */
+struct Timer {
+    Timer* prev = nullptr;
+    Timer* next = nullptr;
+    uint64_t expires = 0;  // 틱 단위 만료 시각
+    void* data = nullptr;
+
+    bool scheduled() const noexcept {
+        return prev != nullptr;
+    }
+};
+
+/**
+ * Hierarchical timer wheel in the style of the classic Linux kernel timers.
+ * Time is counted in ticks; level `n` has `TIMER_WHEEL_SLOTS` slots of
+ * `TIMER_WHEEL_SLOTS^n` ticks, and a timer moves down a level each time its
+ * slot comes up, so scheduling and cancelling are O(1) and `advance()` only
+ * touches timers that are due or cascading.
+ *
+ * Owned by one thread; nothing here is synchronised.
+ */
+class TimerWheel {
+public:
+    explicit TimerWheel(uint64_t now) noexcept : now(now) {
+        LOG_TRACE("http::TimerWheel()");
+        for (auto& level : self.levels) {
+            for (Timer& head : level) {
+                head.prev = &head;
+                head.next = &head;
+            }
+        }
+    }
+
+    TimerWheel(TimerWheel&) = delete;
+    TimerWheel& operator=(TimerWheel&) = delete;
+
+    uint64_t current() const noexcept {
+        return self.now;
+    }
+
+    bool empty() const noexcept {
+        return self.count == 0;
+    }
+
+    /**
+     * Schedules `timer` to fire at tick `expires`, moving it if it is already
+     * scheduled. A time that has already passed fires on the next tick.
+     */
+    void schedule(Timer& timer, uint64_t expires) noexcept {
+        self.cancel(timer);
+        timer.expires = expires > self.now ? expires : self.now + 1;
+        self.insert(timer);
+        ++self.count;
+    }
+
+    void cancel(Timer& timer) noexcept {
+        if (timer.scheduled()) {
+            self.unlink(timer);
+            --self.count;
+        }
+    }
+
+    /**
+     * Moves time forward to `to`, calling `on_expire(Timer&)` for every timer
+     * that comes due. The timer is already unscheduled when the callback runs,
+     * so the callback may reschedule it or free its owner.
+     */
+    template <typename F>
+    void advance(uint64_t to, F&& on_expire) {
+        // 타이머가 없으면 돌 필요 없이 시각만 옮긴다
+        if (self.count == 0 && to > self.now) {
+            self.now = to;
+            return;
+        }
+
+        while (self.now < to) {
+            ++self.now;
+
+            // 하위 레벨이 한 바퀴 돌 때마다 상위 레벨 슬롯을 내려보낸다
+            for (size_t level = 1; level < TIMER_WHEEL_LEVELS; ++level) {
+                if (self.slot_index(self.now, level - 1) != 0) {
+                    break;
+                }
+                self.cascade(level, self.slot_index(self.now, level));
+            }
+
+            Timer& head = self.levels[0][self.slot_index(self.now, 0)];
+            while (head.next != &head) {
+                Timer& timer = *head.next;
+                self.unlink(timer);
+                --self.count;
+                on_expire(timer);
+            }
+        }
+    }
+
+private:
+    static size_t slot_index(uint64_t tick, size_t level) noexcept {
+        return static_cast<size_t>(tick >> (TIMER_WHEEL_BITS * level)) &
+               (TIMER_WHEEL_SLOTS - 1);
+    }
+
+    void insert(Timer& timer) noexcept {
+        uint64_t delta = timer.expires - self.now;
+        if (delta >= TIMER_WHEEL_RANGE) {
+            timer.expires = self.now + TIMER_WHEEL_RANGE - 1;
+            delta = TIMER_WHEEL_RANGE - 1;
+        }
+
+        size_t level = 0;
+        while (delta >= (uint64_t{1} << (TIMER_WHEEL_BITS * (level + 1)))) {
+            ++level;
+        }
+
+        Timer& head = self.levels[level][slot_index(timer.expires, level)];
+        timer.prev = head.prev;
+        timer.next = &head;
+        head.prev->next = &timer;
+        head.prev = &timer;
+    }
+
+    static void unlink(Timer& timer) noexcept {
+        timer.prev->next = timer.next;
+        timer.next->prev = timer.prev;
+        timer.prev = nullptr;
+        timer.next = nullptr;
+    }
+
+    void cascade(size_t level, size_t index) noexcept {
+        Timer& head = self.levels[level][index];
+        while (head.next != &head) {
+            Timer& timer = *head.next;
+            self.unlink(timer);
+            self.insert(timer);
+        }
+    }
+
+private:
+    TimerWheel& self = *this;
+
+    // 각 슬롯은 머리 노드를 가진 원형 이중 연결 리스트다
+    std::array<std::array<Timer, TIMER_WHEEL_SLOTS>, TIMER_WHEEL_LEVELS>
+        levels;
+    uint64_t now;
+    size_t count = 0;
+};
+
+}  // namespace http
@@ -1,7 +1,19 @@
 #pragma once
 
+#include "request_parser.cpp"
+
 #include "socket.cpp"
 
 #include "response.cpp"
 
-#include "server.cpp"
\ No newline at end of file
+#include "byte_range.cpp"
+
+#include "conditional.cpp"
+
+#include "compression.cpp"
+
+#include "static_files.cpp"
+
+#include "router.cpp"
+
+#include "server.cpp"
@@ -0,0 +1,176 @@
+// Request parser tests. Every request is parsed whole, one byte at a time and
+// split in two at every byte, since the parser resumes from where it stopped.
+//
+//   clang++ -std=c++2c -O1 ./tests/request_parser_test.cpp -o ./build/request_parser_test
+//   ./build/request_parser_test
+
+#include <cstdint>
+#include <span>
+#include <string>
+#include <vector>
+#include "../src/request_parser.cpp"
+
+namespace {
+
+using http::ParseError;
+using http::ParseResult;
+using http::ParseStatus;
+
+// 두 조각으로 나누는 검사는 짧은 요청에만 한다
+constexpr size_t MAX_SPLIT_SIZE = 4096;
+
+struct Case {
+    std::string name;
+    std::string raw;
+    ParseStatus status;
+    ParseError error = ParseError::None;
+    std::string body{};
+};
+
+size_t failures = 0;
+
+void fail(const Case& test, std::string_view how, const ParseResult& result) {
+    ++failures;
+    std::println("FAIL {} ({}): status {} error {}", test.name, how,
+        static_cast<int32_t>(result.status),
+        http::parse_error_to_string(result.error));
+}
+
+// 끝난 결과가 기대와 같은지
+bool matches(const Case& test, const ParseResult& result,
+    const http::Request& request, size_t size) {
+    if (result.status != test.status) {
+        return false;
+    }
+    if (result.status == ParseStatus::Error) {
+        return result.error == test.error;
+    }
+    return result.consumed == size && request.body == test.body;
+}
+
+void parse_whole(const Case& test) {
+    std::string buffer = test.raw;
+    http::RequestParser parser;
+    http::Request request{};
+
+    ParseResult result = parser.parse(std::span<char>(buffer), request);
+    if (!matches(test, result, request, buffer.size())) {
+        fail(test, "whole", result);
+    }
+}
+
+// 받은 바이트가 하나씩 늘어나는 것처럼 매번 앞부분 전체를 다시 넘긴다
+void parse_bytewise(const Case& test) {
+    std::string buffer = test.raw;
+    http::RequestParser parser;
+    http::Request request{};
+
+    for (size_t n = 1; n <= buffer.size(); ++n) {
+        ParseResult result =
+            parser.parse(std::span<char>(buffer.data(), n), request);
+        if (result.status == ParseStatus::Incomplete) {
+            continue;
+        }
+        if (!matches(test, result, request, buffer.size()) ||
+            (result.status == ParseStatus::Complete && n != buffer.size())) {
+            fail(test, std::format("bytewise at {}", n), result);
+        }
+        return;
+    }
+
+    fail(test, "bytewise never finished", ParseResult{ParseStatus::Incomplete});
+}
+
+void parse_split(const Case& test) {
+    for (size_t k = 1; k < test.raw.size(); ++k) {
+        std::string buffer = test.raw;
+        http::RequestParser parser;
+        http::Request request{};
+
+        ParseResult result =
+            parser.parse(std::span<char>(buffer.data(), k), request);
+        if (result.status == ParseStatus::Incomplete) {
+            result = parser.parse(std::span<char>(buffer), request);
+        }
+        if (!matches(test, result, request, buffer.size())) {
+            fail(test, std::format("split at {}", k), result);
+            return;
+        }
+    }
+}
+
+std::vector<Case> make_cases() {
+    std::vector<Case> cases;
+
+    cases.push_back({"get",
+        "GET /index.html?x=1 HTTP/1.1\r\nHost: example.com\r\n"
+        "Accept: */*\r\n\r\n",
+        ParseStatus::Complete});
+    cases.push_back({"content-length",
+        "POST /echo HTTP/1.1\r\nContent-Length: 11\r\n\r\nHello World",
+        ParseStatus::Complete, ParseError::None, "Hello World"});
+    cases.push_back({"chunked",
+        "POST /echo HTTP/1.1\r\nTransfer-Encoding: chunked\r\n\r\n"
+        "5;name=value\r\nHello\r\n0006\r\n World\r\n0\r\n"
+        "Trailer-One: 1\r\nTrailer-Two: 2\r\n\r\n",
+        ParseStatus::Complete, ParseError::None, "Hello World"});
+    cases.push_back({"chunk size digits at limit",
+        "POST / HTTP/1.1\r\nTransfer-Encoding: chunked\r\n\r\n"
+        "000000000000000b\r\nHello World\r\n0\r\n\r\n",
+        ParseStatus::Complete, ParseError::None, "Hello World"});
+
+    // 앞의 0 은 chunk_remaining 을 키우지 않으므로 자릿수로 막는다
+    cases.push_back({"chunk size leading zeros",
+        "POST / HTTP/1.1\r\nTransfer-Encoding: chunked\r\n\r\n" +
+            std::string(http::MAX_CHUNK_SIZE_DIGITS, '0') + "1\r\nx\r\n",
+        ParseStatus::Error, ParseError::InvalidChunk});
+    cases.push_back({"chunk extension too large",
+        "POST / HTTP/1.1\r\nTransfer-Encoding: chunked\r\n\r\n1;" +
+            std::string(http::MAX_HEADER_SIZE, 'a'),
+        ParseStatus::Error, ParseError::HeaderTooLarge});
+
+    std::string unterminated_trailer =
+        "POST / HTTP/1.1\r\nTransfer-Encoding: chunked\r\n\r\n0\r\nX: " +
+        std::string(http::MAX_HEADER_SIZE, 'a');
+    cases.push_back({"trailer line too large", unterminated_trailer,
+        ParseStatus::Error, ParseError::HeaderTooLarge});
+
+    std::string trailers =
+        "POST / HTTP/1.1\r\nTransfer-Encoding: chunked\r\n\r\n0\r\n";
+    for (size_t i = 0; i <= http::MAX_HEADER_COUNT; ++i) {
+        trailers += "X: y\r\n";
+    }
+    trailers += "\r\n";
+    cases.push_back({"too many trailers", trailers, ParseStatus::Error,
+        ParseError::TooManyHeaders});
+
+    // 작은 청크가 많아도 청크 줄의 합은 헤더 크기를 넘을 수 없다
+    std::string tiny_chunks =
+        "POST / HTTP/1.1\r\nTransfer-Encoding: chunked\r\n\r\n";
+    while (tiny_chunks.size() < 2 * http::MAX_HEADER_SIZE) {
+        tiny_chunks += "1;a=b\r\nx\r\n";
+    }
+    cases.push_back({"chunk framing too large", tiny_chunks,
+        ParseStatus::Error, ParseError::HeaderTooLarge});
+
+    return cases;
+}
+
+}  // namespace
+
+int main() {
+    for (const Case& test : make_cases()) {
+        parse_whole(test);
+        parse_bytewise(test);
+        if (test.raw.size() <= MAX_SPLIT_SIZE) {
+            parse_split(test);
+        }
+    }
+
+    if (failures != 0) {
+        std::println("{} failures", failures);
+        return 1;
+    }
+    std::println("all passed");
+    return 0;
+}